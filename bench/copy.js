@@ -0,0 +1,43 @@
+const {connectAll, finishAll, bench} = require('./harness');
+
+const ROWS = 20000;
+
+const makeData = ()=>{
+  const lines = [];
+  for (let i = 0; i < ROWS; ++i)
+    lines.push(`${i}\tname ${i} ${'x'.repeat(i % 64)}\t2020-01-01 00:00:${i % 60}+00\n`);
+  return Buffer.from(lines.join(''));
+};
+
+const copyFrom = (pg, data)=> new Promise((resolve, reject)=>{
+  const stream = pg.copyFromStream('COPY bench_copy FROM STDIN', err =>{
+    if (err) reject(err);
+    else resolve(data.length);
+  });
+  for (let i = 0; i < data.length; i += 65536)
+    stream.write(data.subarray(i, i + 65536));
+  stream.end();
+});
+
+const copyTo = async pg =>{
+  let bytes = 0;
+  for await (const chunk of pg.copyToStream('COPY bench_copy TO STDOUT')) bytes += chunk.length;
+  return bytes;
+};
+
+module.exports = async ()=>{
+  const [pg] = await connectAll(1);
+  try {
+    await pg.exec('CREATE TEMPORARY TABLE bench_copy (id int, name text, at timestamptz)');
+    const data = makeData();
+    await bench('copyFromStream', [pg], async pg =>{
+      await pg.exec('TRUNCATE bench_copy');
+      return copyFrom(pg, data);
+    });
+    await pg.exec('TRUNCATE bench_copy');
+    await copyFrom(pg, data);
+    await bench('copyToStream', [pg], copyTo);
+  } finally {
+    finishAll([pg]);
+  }
+};
@@ -0,0 +1,54 @@
+const {connectAll, finishAll, bench} = require('./harness');
+
+const FAMILIES = {
+  int: 'i::int',
+  bigint: 'i::bigint * 1000003',
+  float: 'i::float8 / 7',
+  numeric: '(i::numeric / 7)::numeric(20,6)',
+  bool: 'i % 2 = 0',
+  text: `'value ' || i`,
+  status: `(ARRAY['active', 'pending', 'closed', 'archived'])[i % 4 + 1]`,
+  timestamptz: `'2020-01-01'::timestamptz + i * interval '1 minute'`,
+  date: `'2020-01-01'::date + i`,
+  json: `json_build_object('id', i, 'name', 'n' || i)`,
+  uuid: `md5(i::text)::uuid`,
+  interval: `i * interval '1 second'`,
+  intArray: 'ARRAY[i, i+1, i+2, i+3]',
+  textArray: `ARRAY['a' || i, 'b', 'c d']`,
+  bytea: `decode(md5(i::text) || md5((i+1)::text), 'hex')`,
+};
+
+const columns = (expr, width)=> Array.from({length: width}, (_, c)=> `${expr} AS c${c}`).join(', ');
+
+const select = (expr, width, rows)=>
+      `SELECT ${columns(expr, width)} FROM generate_series(1, ${rows}) AS i`;
+
+const SHAPES = {
+  long: {width: 2, rows: 10000},
+  wide: {width: 50, rows: 200},
+};
+
+module.exports = async ()=>{
+  const [pg] = await connectAll(1);
+  try {
+    for (const type in FAMILIES) {
+      for (const shape in SHAPES) {
+        const {width, rows} = SHAPES[shape];
+        const sql = select(FAMILIES[type], width, rows);
+        await bench(`decode.${type}.${shape}`, [pg], pg => pg.exec(sql),
+                    {rowsPerOp: rows, trackConvert: true});
+      }
+    }
+
+    await pg.exec(`CREATE TEMPORARY TABLE bench_heavy AS SELECT i,
+decode(repeat(md5(i::text), 256), 'hex') AS data,
+array(SELECT generate_series(i, i+255)) AS ints
+FROM generate_series(1, 200) AS i`);
+    await bench('decode.byteaHeavy', [pg], pg => pg.exec('SELECT i, data FROM bench_heavy'),
+                {rowsPerOp: 200, trackConvert: true});
+    await bench('decode.arrayHeavy', [pg], pg => pg.exec('SELECT i, ints FROM bench_heavy'),
+                {rowsPerOp: 200, trackConvert: true});
+  } finally {
+    finishAll([pg]);
+  }
+};
@@ -0,0 +1,64 @@
+const PG = require('../');
+const diagnostics_channel = require('diagnostics_channel');
+
+const options = {
+  duration: 2000,
+  warmup: 200,
+  connections: [1, 2, 4, 8],
+  conninfo: void 0,
+  filter: null,
+};
+
+const results = [];
+
+const connectAll = n => Promise.all(Array.from({length: n}, ()=> PG.connect(options.conninfo)));
+
+const finishAll = clients =>{for (const pg of clients) pg.finish()};
+
+const selected = name => options.filter === null || options.filter.test(name);
+
+/* Run op(pg) back to back on each client until the duration ends.
+   op may return the number of bytes it moved. */
+const runFor = async (clients, op, duration)=>{
+  const end = Date.now() + duration;
+  let ops = 0, bytes = 0;
+  await Promise.all(clients.map(async pg =>{
+    while (Date.now() < end) {
+      const n = await op(pg);
+      if (typeof n === 'number') bytes += n;
+      ++ops;
+    }
+  }));
+  return {ops, bytes};
+};
+
+const convertTime = ()=>{
+  let total = 0;
+  const onQuery = ({detail}) =>{total += detail.convert};
+  diagnostics_channel.subscribe('pg-libpq:query', onQuery);
+  return ()=>{
+    diagnostics_channel.unsubscribe('pg-libpq:query', onQuery);
+    return total;
+  };
+};
+
+const bench = async (name, clients, op, {rowsPerOp=0, trackConvert=false}={})=>{
+  if (! selected(name)) return;
+  await runFor(clients, op, options.warmup);
+  const stopConvert = trackConvert ? convertTime() : null;
+  const start = process.hrtime.bigint();
+  const {ops, bytes} = await runFor(clients, op, options.duration);
+  const secs = Number(process.hrtime.bigint() - start) / 1e9;
+  const result = {
+    name, connections: clients.length, ops,
+    opsPerSec: Math.round(ops / secs),
+    meanMs: +(secs * 1000 * clients.length / ops).toFixed(4),
+  };
+  if (rowsPerOp !== 0) result.rowsPerSec = Math.round(ops * rowsPerOp / secs);
+  if (bytes !== 0) result.mbPerSec = +(bytes / secs / 1048576).toFixed(2);
+  if (stopConvert !== null) result.convertMs = +(stopConvert() / ops).toFixed(4);
+  results.push(result);
+  console.error(JSON.stringify(result));
+};
+
+module.exports = {options, results, connectAll, finishAll, selected, bench};
@@ -0,0 +1,19 @@
+const {options, connectAll, finishAll, bench} = require('./harness');
+
+module.exports = async ()=>{
+  for (const n of options.connections) {
+    const clients = await connectAll(n);
+    try {
+      await bench('exec', clients, pg => pg.exec('SELECT 1'));
+
+      let i = 0;
+      await bench('execParams', clients, pg => pg.execParams(
+        'SELECT $1::int + 1 AS a, $2::text AS b', [++i, 'abc']));
+
+      await Promise.all(clients.map(pg => pg.prepare('bench1', 'SELECT $1::int + 1 AS a, $2::text AS b')));
+      await bench('execPrepared', clients, pg => pg.execPrepared('bench1', [++i, 'abc']));
+    } finally {
+      finishAll(clients);
+    }
+  }
+};
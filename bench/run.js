@@ -0,0 +1,90 @@
+const fs = require('fs');
+const os = require('os');
+const {execSync} = require('child_process');
+const PG = require('../');
+const {options, results} = require('./harness');
+
+const SUITES = {
+  queries: require('./queries'),
+  decode: require('./decode'),
+  copy: require('./copy'),
+  workers: require('./workers'),
+};
+
+const usage = ()=>{
+  console.error(`usage: node bench/run.js [suite...] [--duration=ms] [--connections=1,2,4,8]
+       [--filter=regexp] [--conninfo=string] [--out=file] [--compare=baseline.json]
+
+suites: ${Object.keys(SUITES).join(', ')}`);
+  process.exit(1);
+};
+
+const parseArgs = argv =>{
+  const suites = [];
+  let out = null, compare = null;
+  for (const arg of argv) {
+    const m = /^--([a-z]+)=(.*)$/.exec(arg);
+    if (m === null) {
+      if (SUITES[arg] === void 0) usage();
+      suites.push(arg);
+      continue;
+    }
+    const [, key, value] = m;
+    switch (key) {
+    case 'duration': options.duration = +value; options.warmup = Math.ceil(+value / 10); break;
+    case 'connections': options.connections = value.split(',').map(n => +n); break;
+    case 'filter': options.filter = new RegExp(value); break;
+    case 'conninfo': options.conninfo = value; break;
+    case 'out': out = value; break;
+    case 'compare': compare = value; break;
+    default: usage();
+    }
+  }
+  return {suites: suites.length == 0 ? Object.keys(SUITES) : suites, out, compare};
+};
+
+const gitCommit = ()=>{
+  try {
+    return execSync('git rev-parse --short HEAD', {cwd: __dirname, stdio: ['ignore', 'pipe', 'ignore']})
+      .toString().trim();
+  } catch (err) {
+    return null;
+  }
+};
+
+const resultKey = r => `${r.name}/${r.connections}`;
+
+const compareWith = (file, report)=>{
+  const baseline = new Map(JSON.parse(fs.readFileSync(file)).results.map(r => [resultKey(r), r]));
+  for (const r of report.results) {
+    const base = baseline.get(resultKey(r));
+    if (base === void 0) continue;
+    const change = (r.opsPerSec - base.opsPerSec) / base.opsPerSec * 100;
+    console.error(`${resultKey(r).padEnd(32)} ${String(base.opsPerSec).padStart(10)} -> ${
+String(r.opsPerSec).padStart(10)} ops/s ${(change < 0 ? '' : '+') + change.toFixed(1)}%`);
+  }
+};
+
+const main = async ()=>{
+  const {suites, out, compare} = parseArgs(process.argv.slice(2));
+  for (const name of suites) await SUITES[name]();
+
+  const report = {
+    commit: gitCommit(),
+    date: new Date().toISOString(),
+    node: process.version,
+    cpus: os.cpus().length,
+    duration: options.duration,
+    results,
+    errors: PG.stats().errors,
+  };
+  const json = JSON.stringify(report, null, 2);
+  if (out === null) console.log(json);
+  else fs.writeFileSync(out, json + '\n');
+  if (compare !== null) compareWith(compare, report);
+};
+
+main().catch(err =>{
+  console.error(err);
+  process.exit(1);
+});
@@ -0,0 +1,76 @@
+const path = require('path');
+const {Worker} = require('worker_threads');
+const {options, results, connectAll, finishAll, selected, bench} = require('./harness');
+
+const ROWS = 20000;
+
+const SQL = `SELECT i, 'value ' || i AS t, i::float8 / 7 AS f,
+'2020-01-01'::timestamptz + i * interval '1 minute' AS d FROM generate_series(1, ${ROWS}) AS i`;
+
+const WORKER = `
+const {parentPort, workerData: {lib, conninfo, sql, warmup, duration}} = require('worker_threads');
+const PG = require(lib);
+const runFor = async (pg, ms)=>{
+  const end = Date.now() + ms;
+  let ops = 0;
+  while (Date.now() < end) {
+    await pg.exec(sql);
+    ++ops;
+  }
+  return ops;
+};
+PG.connect(conninfo).then(async pg =>{
+  await runFor(pg, warmup);
+  parentPort.postMessage({ready: true});
+  parentPort.once('message', async ()=>{
+    parentPort.postMessage({ops: await runFor(pg, duration)});
+    pg.finish();
+  });
+});
+`;
+
+const message = worker => new Promise((resolve, reject)=>{
+  worker.once('message', resolve);
+  worker.once('error', reject);
+});
+
+/* Each worker decodes on its own thread with one connection; compare with workers.main. */
+const inWorkers = async n =>{
+  const name = 'workers.threads';
+  if (! selected(name)) return;
+  const workerData = {
+    lib: path.resolve(__dirname, '..'), conninfo: options.conninfo, sql: SQL,
+    warmup: options.warmup, duration: options.duration,
+  };
+  const workers = Array.from({length: n}, ()=> new Worker(WORKER, {eval: true, workerData}));
+  try {
+    await Promise.all(workers.map(message));
+    const start = process.hrtime.bigint();
+    const done = workers.map(message);
+    for (const w of workers) w.postMessage('go');
+    const ops = (await Promise.all(done)).reduce((sum, r)=> sum + r.ops, 0);
+    const secs = Number(process.hrtime.bigint() - start) / 1e9;
+    const result = {
+      name, connections: n, ops,
+      opsPerSec: Math.round(ops / secs),
+      meanMs: +(secs * 1000 * n / ops).toFixed(4),
+      rowsPerSec: Math.round(ops * ROWS / secs),
+    };
+    results.push(result);
+    console.error(JSON.stringify(result));
+  } finally {
+    await Promise.all(workers.map(w => w.terminate()));
+  }
+};
+
+module.exports = async ()=>{
+  for (const n of options.connections) {
+    const clients = await connectAll(n);
+    try {
+      await bench('workers.main', clients, pg => pg.exec(SQL), {rowsPerOp: ROWS});
+    } finally {
+      finishAll(clients);
+    }
+    await inWorkers(n);
+  }
+};
@@ -1,28 +1,54 @@
 {
+  'variables': {
+    'pgconfig%': 'pg_config',
+    'decode_bench%': 0,
+    'fuzz%': 0,
+  },
+  'target_defaults': {
+    'include_dirs': [
+      '<!@(<(pgconfig) --includedir)'
+    ],
+    'conditions': [
+      ['OS=="win"', {
+        'libraries' : ['libpq.lib'],
+        'msvs_settings': {
+          'VCLinkerTool' : {
+            'AdditionalLibraryDirectories' : [
+              '<!@(<(pgconfig) --libdir)\\'
+            ]
+          },
+        }
+      }, { # OS!="win"
+           'libraries' : ['-lpq -L<!@(<(pgconfig) --libdir)']
+         }]
+    ]
+  },
   "targets": [
     {
       "target_name": "pg_libpq",
-      'variables': {
-        'pgconfig': 'pg_config',
-      },
       "sources": [ "src/pg-libpq.c" ],
-      "include_dirs": [
-        '<!@(<(pgconfig) --includedir)'
-      ],
-      'conditions': [
-        ['OS=="win"', {
-          'libraries' : ['libpq.lib'],
-          'msvs_settings': {
-            'VCLinkerTool' : {
-              'AdditionalLibraryDirectories' : [
-                '<!@(<(pgconfig) --libdir)\\'
-              ]
-            },
-          }
-        }, { # OS!="win"
-             'libraries' : ['-lpq -L<!@(<(pgconfig) --libdir)']
-           }]
-      ]
     }
+  ],
+  'conditions': [
+    ['decode_bench==1', {
+      'targets': [
+        {
+          'target_name': 'decode_bench',
+          'sources': [ 'src/decode-bench.c' ],
+          'cflags': [ '-Wno-unused-function' ],
+        }
+      ]
+    }],
+    ['fuzz==1', {
+      'targets': [
+        {
+          'target_name': 'fuzz_convert',
+          'type': 'executable',
+          'sources': [ 'src/fuzz/fuzz-convert.c' ],
+          'cflags': [ '-g', '-O1', '-fsanitize=fuzzer,address,undefined', '-Wno-unused-function' ],
+          'ldflags': [ '-fsanitize=fuzzer,address,undefined' ],
+        }
+      ]
+    }],
   ]
 }
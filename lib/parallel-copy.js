@@ -0,0 +1,170 @@
+const stream = require('stream');
+const util = require('util');
+
+const finished = util.promisify(stream.finished);
+
+const NEWLINE = 10;
+
+const copyColumns = columns => columns === void 0 ? '*' : columns.join(', ');
+const copyOptions = options => options === void 0 ? '' : ` WITH (${options})`;
+
+const checkClients = clients =>{
+  if (! Array.isArray(clients) || clients.length === 0)
+    throw new Error('clients must be a non-empty array');
+};
+
+const settle = async promises =>{
+  const results = await Promise.allSettled(promises);
+  const failed = results.find(r => r.status === 'rejected');
+  if (failed !== void 0) throw failed.reason;
+  return results.map(r => r.value);
+};
+
+const shareSnapshot = async clients =>{
+  const begin = 'BEGIN ISOLATION LEVEL REPEATABLE READ, READ ONLY';
+  await clients[0].exec(begin);
+  const [{snapshot}] = await clients[0].exec('SELECT pg_export_snapshot() AS snapshot');
+  await settle(clients.slice(1).map(async client =>{
+    await client.exec(begin);
+    await client.exec(`SET TRANSACTION SNAPSHOT ${client.escapeLiteral(snapshot)}`);
+  }));
+};
+
+const keyRanges = async (client, table, key, parts)=>{
+  const [{lo, hi}] = await client.exec(
+    `SELECT min(${key})::text AS lo, max(${key})::text AS hi FROM ${table}`);
+  if (lo === void 0) return [];
+  const min = BigInt(lo), max = BigInt(hi);
+  const step = (max - min) / BigInt(parts) + 1n;
+  const ranges = [];
+  for (let from = min; from <= max; from += step)
+    ranges.push(`${key} >= ${from} AND ${key} < ${from + step}`);
+  return ranges;
+};
+
+const ctidRanges = async (client, table, parts)=>{
+  const [{pages}] = await client.execParams(
+    "SELECT (pg_relation_size($1::regclass) / current_setting('block_size')::int)::int AS pages",
+    [table]);
+  const n = Math.max(1, Math.min(parts, pages));
+  const step = Math.ceil(pages / n);
+  return Array.from({length: n}, (_, i)=>[
+    i === 0 ? '' : `ctid >= '(${i * step},0)'::tid`,
+    i === n - 1 ? '' : `ctid < '(${(i + 1) * step},0)'::tid`,
+  ].filter(c => c !== '').join(' AND ') || 'true');
+};
+
+const parallelCopyTo = async (clients, {table, columns, options, key, parts=clients.length,
+                                         snapshot=clients.length > 1, progress}, handler)=>{
+  checkClients(clients);
+  if (! Number.isInteger(parts) || parts < 1)
+    throw new RangeError('parts must be a positive integer');
+  try {
+    if (snapshot) await shareSnapshot(clients);
+    const ranges = key === void 0
+          ? await ctidRanges(clients[0], table, parts)
+          : await keyRanges(clients[0], table, key, parts);
+    const select = `SELECT ${copyColumns(columns)} FROM ${table}`;
+    let next = 0, done = 0, failed = false;
+    await settle(clients.map(async client =>{
+      while (! failed && next < ranges.length) {
+        const part = {index: next, where: ranges[next++]};
+        const copy = client.copyToStream(
+          `COPY (${select} WHERE ${part.where}) TO STDOUT${copyOptions(options)}`);
+        try {
+          await handler(copy, part);
+          await finished(copy);
+        } catch(err) {
+          failed = true;
+          copy.destroy();
+          throw err;
+        }
+        progress && progress(part, ++done, ranges.length);
+      }
+    }));
+    return ranges.length;
+  } finally {
+    if (snapshot)
+      await settle(clients.map(client => client.isClosed() || client.exec('COMMIT')));
+  }
+};
+
+const parallelCopyFrom = async (clients, input, {table, columns, options, chunkSize=1 << 20,
+                                                 transaction=true, progress}={})=>{
+  checkClients(clients);
+  if (! Number.isInteger(chunkSize) || chunkSize < 1)
+    throw new RangeError('chunkSize must be a positive integer');
+  const command = `COPY ${table}${columns === void 0 ? '' : ` (${copyColumns(columns)})`}`+
+        ` FROM STDIN${copyOptions(options)}`;
+  if (transaction) await settle(clients.map(client => client.exec('BEGIN')));
+
+  let error = null, bytes = 0, chunks = 0, acked = 0, failed;
+  const failure = new Promise(resolve =>{failed = resolve});
+  const fail = err =>{
+    if (error !== null) return;
+    error = err;
+    failed();
+  };
+  const done = [];
+  const writers = clients.map(client =>{
+    let callback;
+    done.push(new Promise((resolve, reject)=>{callback = err => err ? reject(err) : resolve()}));
+    const writer = client.copyFromStream(command, err =>{
+      if (err) fail(err);
+      callback(err);
+    });
+    writer.on('error', fail);
+    return writer;
+  });
+
+  const send = async chunk =>{
+    let writer = writers[0];
+    for (const w of writers)
+      if (w.writableLength < writer.writableLength) writer = w;
+    if (writer.writableNeedDrain)
+      await Promise.race([failure, new Promise(resolve =>{writer.once('drain', resolve)})]);
+    if (error !== null) return;
+    const length = chunk.length;
+    ++chunks;
+    writer.write(chunk, err =>{
+      if (err) return;
+      bytes += length;
+      progress && progress(bytes, ++acked);
+    });
+  };
+
+  try {
+    let pending = [], pendingLength = 0;
+    for await (let data of input) {
+      if (error !== null) break;
+      if (typeof data === 'string') data = Buffer.from(data);
+      pending.push(data);
+      pendingLength += data.length;
+      if (pendingLength < chunkSize) continue;
+      const buffer = Buffer.concat(pending, pendingLength);
+      const end = buffer.lastIndexOf(NEWLINE) + 1;
+      if (end === 0) {
+        pending = [buffer];
+        continue;
+      }
+      await send(buffer.subarray(0, end));
+      pending = end === buffer.length ? [] : [buffer.subarray(end)];
+      pendingLength = buffer.length - end;
+    }
+    if (pendingLength !== 0 && error === null)
+      await send(Buffer.concat(pending, pendingLength));
+  } catch(err) {
+    fail(err);
+  }
+
+  for (const w of writers) w.end();
+  await Promise.allSettled(done);
+
+  if (transaction)
+    await settle(clients.map(client => client.isClosed() ||
+                             client.exec(error === null ? 'COMMIT' : 'ROLLBACK')));
+  if (error !== null) throw error;
+  return {bytes, chunks};
+};
+
+module.exports = {parallelCopyTo, parallelCopyFrom};
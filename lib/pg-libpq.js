@@ -1,8 +1,12 @@
 const util = require('util');
 const stream = require('stream');
 const fs = require('fs');
+const {performance} = require('perf_hooks');
+const parallelCopy = require('./parallel-copy');
+const ResultCache = require('./result-cache');
+const Pool = require('./pool');
+const {Recorder} = require('./recorder');
 
-const PARSERS = require('./parsers');
 const PGLibPQ = (()=>{
   try {
     return require('../build/Release/pg_libpq.node');
@@ -12,7 +16,15 @@ const PGLibPQ = (()=>{
 })();
 
 const pq$ = Symbol(), abortCopy$ = Symbol(),
-      queueHead$ = Symbol(), queueTail$ = Symbol();
+      queueHead$ = Symbol(), queueTail$ = Symbol(), trace$ = Symbol();
+
+const queryChannel = (()=>{
+  try {
+    return require('diagnostics_channel').channel('pg-libpq:query');
+  } catch(err) {
+    return null;
+  }
+})();
 
 const ERROR_FIELDS = {
   SEVERITY: 'S',
@@ -38,6 +50,17 @@ for(const k in ERROR_FIELDS) {
   ERROR_FIELDS[k] = ERROR_FIELDS[k].charCodeAt(0);
 }
 
+const TYPE_MODES = ['text', 'number', 'object', 'buffer'];
+
+const PQTRANS_IDLE = 0;
+
+let cursorCount = 0;
+
+/* Registered parsers for these are given milliseconds since the epoch, or +-Infinity; without one
+   the values become Dates natively, as parseDate would make them. */
+const DATE_OIDS = [1082, 1114, 1184, 1115, 1182, 1185];
+const parseDate = value => value === Infinity || value === -Infinity ? value : new Date(value);
+
 const toNum = n => +n;
 const identity = n => n;
 
@@ -53,60 +76,12 @@ const dv = new DataView(ab);
 const iu8 = new Uint8Array(ab);
 const u32 = new Uint32Array(ab);
 
-const toHex = (buffer)=> '\\x'+buffer.toString('hex');
-
-const threePad = n => n < 100 ? n < 10 ? '00'+n : '0'+n : ''+n;
-const fourPad = n => n < 1000 ? '0'+threePad(n) : ''+n;
-
-const dateToSql = d =>{
-  const year = d.getUTCFullYear();
-  if (year > 0) return d.toISOString();
-  return fourPad(1-year)+'-'+(d.getUTCMonth()+1)+'-'+d.getUTCDate()+
-    'T'+d.getUTCHours() + ':' + d.getUTCMinutes() + ':'
-    + d.getUTCSeconds() + '.' + threePad(d.getUTCMilliseconds()) + ' BC';
-};
-
-const toSql = (obj)=>{
-  switch(typeof obj) {
-  case 'undefined':
-    return null;
-  case 'object':
-    if (obj === null) return null;
-    const {constructor} = obj;
-    if (constructor === Uint8Array) return toHex(Buffer.from(obj));
-    if (constructor === Buffer) return toHex(obj);
-    if (constructor === Date) return dateToSql(obj);
-    return JSON.stringify(obj);
-  default:
-    return obj.toString();
-  }
-};
-
-const quoteArrayValueRE = /[\\,"}{\s]/;
-
-const wrapArrayValue = v => v == null
-      ? 'NULL' : (
-        Array.isArray(v)
-          ? sqlArray(v) : (
-            v === '' || v === 'NULL' || v === 'null' || quoteArrayValueRE.test(v = toSql(v))
-              ? JSON.stringify(v) : v.toString()));
-
-const convertArray = (v, converter)=>{
-  for(let i = v.length-1; i >= 0; --i) {
-    const item = v[i];
-    if (Array.isArray(item))
-      convertArray(item, converter);
-    else
-      v[i] = converter(item);
-  }
-};
-
 const sqlArray  = array =>{
   if (array == null) return array;
   if (! Array.isArray(array))
     throw new Error('argument must be an array');
 
-  return '{'+array.map(v => Array.isArray(v) ? sqlArray(v) : wrapArrayValue(v)).join(',')+'}';
+  return PGLibPQ.sqlArray(array);
 };
 
 
@@ -122,7 +97,8 @@ class PG {
 
     const pq = this[pq$] = new PGLibPQ();
 
-    this[queueHead$] = this[queueTail$] = {func: null, next: null};
+    this[queueHead$] = this[queueTail$] = {func: null, next: null, started: true, pipelined: false};
+    this[trace$] = false;
 
     if (typeof params !== 'string')
       throw new Error("invalid params argument");
@@ -160,10 +136,45 @@ class PG {
     });
   }
 
+  static connectMany(params='', n, callback) {
+    if (callback !== void 0) {
+      PG.connectMany(params, n).then(clients => callback(null, clients), callback);
+      return;
+    }
+    if (! Number.isInteger(n) || n < 0)
+      return Promise.reject(new RangeError("n must be a non-negative integer"));
+
+    return Promise.allSettled(Array.from({length: n}, ()=> PG.connect(params))).then(results =>{
+      const failed = results.find(r => r.status === 'rejected');
+      if (failed === void 0) return results.map(r => r.value);
+      for (const r of results) if (r.status === 'fulfilled') r.value.finish();
+      throw failed.reason;
+    });
+  }
+
   static registerType(typeOid, parseFunction) {
-    const prev = PARSERS[typeOid];
-    PARSERS[typeOid] = parseFunction;
-    return prev;
+    const prev = PGLibPQ.registerType(typeOid, parseFunction);
+    return prev === void 0 && DATE_OIDS.includes(typeOid) ? parseDate : prev;
+  }
+
+  static setTypeMode(typeOid, mode) {
+    const index = TYPE_MODES.indexOf(mode);
+    if (index === -1) throw new Error("invalid type mode: "+mode);
+    return TYPE_MODES[PGLibPQ.setTypeMode(typeOid, index)];
+  }
+
+  static setConvertBudget({rows=0, ms=4}={}) {
+    PGLibPQ.setConvertBudget(rows, ms * 1000);
+  }
+
+  static setInternStrings({maxLength=32}={}) {
+    PGLibPQ.setInternLength(maxLength);
+  }
+
+  static setQueueDepth({depth=MAX_QUEUE_DEPTH}={}) {
+    if (! Number.isInteger(depth) || depth < 1 || depth > MAX_QUEUE_DEPTH)
+      throw new RangeError(`depth must be an integer from 1 to ${MAX_QUEUE_DEPTH}`);
+    queueDepth = depth;
   }
 
   finish() {
@@ -184,38 +195,98 @@ class PG {
 
   escapeLiteral(value) {return this[pq$].escapeLiteral(value.toString())}
 
-  exec(command, callback) {
-    return promisify(this, callback, cb =>{this[pq$].execParams(command.toString(), null, cb)});
+  exec(command, options, callback) {
+    let mode;
+    [mode, callback] = resultOptions(options, callback);
+    command = command.toString();
+    return cachedQuery(this, callback, options, ['e', command, null, mode], cb =>{
+      this[pq$].execParams(command, null, mode, cb);
+    }, command, ['q', command, null]);
   }
 
-  execParams(command, params, callback) {
+  execParams(command, params, options, callback) {
     if (! Array.isArray(params))
       throw new Error('params must be an array');
 
-    return promisify(this, callback, cb =>{
-      this[pq$].execParams(command.toString(), params.map(toSql), cb);
-    });
+    let mode;
+    [mode, callback] = resultOptions(options, callback);
+    command = command.toString();
+    return cachedQuery(this, callback, options, ['e', command, params, mode], cb =>{
+      this[pq$].execParams(command, params, mode, cb);
+    }, command, ['q', command, params]);
   }
 
   prepare(name, command, callback) {
+    name = name.toString();
+    command = command.toString();
     return promisify(this, callback, cb =>{
-      this[pq$].prepare(name.toString(), command.toString(), cb);
-    });
+      this[pq$].prepare(name, command, cb);
+    }, name, ['p', name, command], true);
   }
 
-  execPrepared(name, params, callback) {
+  execPrepared(name, params, options, callback) {
     if (! Array.isArray(params))
       throw new Error('params must be an array');
 
-    params = params.map(toSql);
+    let mode;
+    [mode, callback] = resultOptions(options, callback);
+    name = name.toString();
+    return cachedQuery(this, callback, options, ['p', name, params, mode], cb =>{
+      this[pq$].execPrepared(name, params, mode, cb);
+    }, name, ['e', name, params]);
+  }
+
+  execPreparedBatch(name, paramSets, callback) {
+    if (! Array.isArray(paramSets) || ! paramSets.every(Array.isArray))
+      throw new Error('paramSets must be an array of arrays');
 
+    name = name.toString();
     return promisify(this, callback, cb =>{
-      this[pq$].execPrepared(name.toString(), params, cb);
-    });
+      this[pq$].execPreparedBatch(name, paramSets, cb);
+    }, name, ['b', name, paramSets]);
+  }
+
+  waitForNotify(timeout, callback) {
+    if (typeof timeout === 'function') {
+      callback = timeout;
+      timeout = void 0;
+    }
+    return promisify(this, callback, cb =>{this[pq$].waitForNotify(timeout, cb)});
   }
 
   resultErrorField(field) {return this[pq$].resultErrorField(ERROR_FIELDS[field])}
 
+  stats() {return this[pq$].stats()}
+
+  cursor(command, params=[], {batchSize=100}={}) {
+    if (! Array.isArray(params))
+      throw new Error('params must be an array');
+    if (! Number.isSafeInteger(batchSize) || batchSize < 1)
+      throw new RangeError('batchSize must be a positive integer');
+    return cursor(this, command.toString(), params, batchSize);
+  }
+
+  loReadStream(oid, {chunkSize=65536}={}) {
+    return loReadStream(this, oid, loChunkSize(chunkSize));
+  }
+
+  loWriteStream({oid=0, chunkSize=65536}={}) {
+    return loWriteStream(this, oid, loChunkSize(chunkSize));
+  }
+
+  replicationStream(slot, {startLsn='0/0', options={}, statusInterval=10000,
+                           autoAcknowledge=true}={}) {
+    if (! /^[a-z0-9_]+$/.test(slot))
+      throw new Error('invalid replication slot name');
+    if (! Number.isInteger(statusInterval) || statusInterval < 1)
+      throw new RangeError('statusInterval must be a positive integer');
+    const opts = Object.entries(options).map(
+      ([k, v])=> `"${k.replace(/"/g, '""')}" ${this.escapeLiteral(v)}`).join(', ');
+    const command = `START_REPLICATION SLOT ${slot} LOGICAL ${lsnToString(lsnToBigInt(startLsn))}`+
+          (opts === '' ? '' : ` (${opts})`);
+    return replicationStream(this, command, statusInterval, autoAcknowledge);
+  }
+
   copyToStream(command) {
     let ready = false, readSize = 0;
     const push = (data=null)=>{
@@ -356,112 +427,348 @@ class PG {
   }
 }
 
-PG.toSql = toSql;
+/* Sends BEGIN if the connection is idle, resolving to whether it did. The check and the BEGIN take
+   one queue slot so nothing queued meanwhile can open or end a transaction between them. */
+const beginIfIdle = pgConn => promisify(pgConn, void 0, cb =>{
+  const pq = pgConn[pq$];
+  if (pq.transactionStatus() !== PQTRANS_IDLE) return void cb(null, false);
+  pq.execParams('BEGIN', null, 0, err =>{cb(err, err == null)});
+}, 'BEGIN');
+
+const loChunkSize = size =>{
+  if (! Number.isInteger(size) || size < 1 || size > 0x40000000)
+    throw new RangeError('chunkSize must be an integer from 1 to 1GB');
+  return size;
+};
+
+const loCall = (pgConn, func)=> promisify(pgConn, void 0, cb =>{func(pgConn[pq$], cb)});
+
+const loOpen = async (pgConn, lo, oid, write)=>{
+  lo.own = await beginIfIdle(pgConn);
+  if (oid === 0) oid = await loCall(pgConn, (pq, cb)=>{pq.loCreate(cb)});
+  lo.fd = await loCall(pgConn, (pq, cb)=>{pq.loOpen(oid, write, cb)});
+  return oid;
+};
+
+const loClose = async (pgConn, lo, err)=>{
+  const {fd, own} = lo;
+  lo.fd = -1;
+  lo.own = false;
+  if (pgConn.isClosed()) return;
+  if (fd !== -1 && err == null) await loCall(pgConn, (pq, cb)=>{pq.loClose(fd, cb)});
+  if (own) await pgConn.exec(err == null ? 'COMMIT' : 'ROLLBACK');
+};
+
+const loReadStream = (pgConn, oid, chunkSize)=>{
+  const lo = {fd: -1, own: false};
+  const readable = new stream.Readable({
+    highWaterMark: chunkSize,
+    construct: cb =>{loOpen(pgConn, lo, oid, false).then(()=>{cb()}, cb)},
+    read: ()=>{
+      loCall(pgConn, (pq, cb)=>{pq.loRead(lo.fd, chunkSize, cb)}).then(async chunk =>{
+        if (chunk.length !== 0)
+          readable.push(chunk);
+        else {
+          await loClose(pgConn, lo);
+          readable.push(null);
+        }
+      }).catch(err =>{readable.destroy(err)});
+    },
+    destroy: (err, cb)=>{loClose(pgConn, lo, err).then(()=>{cb(err)}, err2 =>{cb(err || err2)})},
+  });
+  return readable;
+};
+
+const loWriteStream = (pgConn, oid, chunkSize)=>{
+  const lo = {fd: -1, own: false};
+  const writeAll = async chunk =>{
+    for (let pos = 0; pos < chunk.length; pos += chunkSize) {
+      const part = chunk.length <= chunkSize ? chunk : chunk.subarray(pos, pos + chunkSize);
+      await loCall(pgConn, (pq, cb)=>{pq.loWrite(lo.fd, part, cb)});
+    }
+  };
+  const writable = new stream.Writable({
+    highWaterMark: chunkSize,
+    construct: cb =>{
+      loOpen(pgConn, lo, oid, true).then(created =>{writable.oid = created; cb()}, cb);
+    },
+    write: (chunk, enc, cb)=>{writeAll(chunk).then(()=>{cb()}, cb)},
+    final: cb =>{loClose(pgConn, lo).then(()=>{cb()}, cb)},
+    destroy: (err, cb)=>{loClose(pgConn, lo, err).then(()=>{cb(err)}, err2 =>{cb(err || err2)})},
+  });
+  writable.oid = oid;
+  return writable;
+};
+
+const lsnToBigInt = lsn =>{
+  if (typeof lsn === 'bigint') return lsn;
+  const m = /^([0-9A-F]{1,8})\/([0-9A-F]{1,8})$/i.exec(lsn);
+  if (m === null) throw new Error(`invalid LSN: ${lsn}`);
+  return BigInt('0x'+m[1]) << 32n | BigInt('0x'+m[2]);
+};
+
+const lsnToString = lsn =>
+      (lsn >> 32n).toString(16).toUpperCase()+'/'+(lsn & 0xffffffffn).toString(16).toUpperCase();
+
+const replicationStream = (pgConn, command, statusInterval, autoAcknowledge)=>{
+  let ready = false, reading = false;
+  const pq = pgConn[pq$];
+  const push = (buf=null, err)=>{
+    // the native side holds the connection lock here, which destroy needs
+    if (err !== void 0) return void process.nextTick(()=>{readable.destroy(err)});
+    if (buf === null) return readable.push(null);
+    const lsn = buf.readBigUInt64BE(1);
+    if (autoAcknowledge) pq.acknowledgeLsn(lsn);
+    return readable.push({
+      lsn: lsnToString(lsn),
+      walEnd: lsnToString(buf.readBigUInt64BE(9)),
+      time: new Date(Number(buf.readBigInt64BE(17) / 1000n) + 946684800000),
+      data: buf.subarray(25),
+    });
+  };
+  const readable = new stream.Readable({
+    objectMode: true,
+    read: ()=>{
+      reading = true;
+      if (ready && ! pgConn.isClosed())
+        pq.getCopyData(push, 1, statusInterval);
+    },
+    destroy: (err, cb)=>{
+      if (! pgConn.isClosed()) pq.getCopyData(push, -1);
+      runNext(pgConn);
+      cb(err);
+    },
+    autoDestroy: true,
+  });
+  readable.acknowledge = lsn =>{
+    if (ready && ! pgConn.isClosed()) pq.acknowledgeLsn(lsnToBigInt(lsn));
+  };
+
+  queueFunc(pgConn, ()=>{
+    if (pgConn.isClosed())
+      return void readable.destroy(connectionClosedError());
+    pq.copyToStream(command, null, (err, result)=>{
+      if (err || pgConn.isClosed())
+        readable.destroy(fetchError(pgConn, err));
+      else if (result !== null)
+        readable.destroy(new Error('Not a COPY_BOTH result'));
+      else {
+        ready = true;
+        if (reading) pq.getCopyData(push, 1, statusInterval);
+      }
+    });
+  });
+
+  return readable;
+};
+
+const cursor = async function *(pgConn, command, params, batchSize) {
+  const name = '"pg_libpq_cursor_'+(++cursorCount)+'"';
+  const ownTransaction = await beginIfIdle(pgConn);
+  let next = null;
+  try {
+    await pgConn.execParams(`DECLARE ${name} NO SCROLL CURSOR FOR ${command}`, params);
+    const fetch = ()=> pgConn.exec(`FETCH ${batchSize} FROM ${name}`);
+    next = fetch();
+    for(;;) {
+      const rows = await next;
+      next = null;
+      if (rows.length < batchSize) {
+        if (rows.length != 0) yield rows;
+        break;
+      }
+      next = fetch();
+      yield rows;
+    }
+  } finally {
+    if (next !== null) next.catch(()=>{});
+    if (! pgConn.isClosed())
+      await pgConn.exec(ownTransaction ? 'COMMIT' : `CLOSE ${name}`).catch(err =>{
+        if (! ownTransaction && err.sqlState !== '25P02') throw err;
+      });
+  }
+};
+
+PG.toSql = PGLibPQ.toSql;
 PG.sqlArray = sqlArray;
+PG.allocStats = PGLibPQ.allocStats;
+PG.lsnToBigInt = lsnToBigInt;
+PG.ResultCache = ResultCache;
+PG.Pool = Pool;
+
+PG.startRecording = path =>{
+  if (recorder !== null) throw new Error('already recording');
+  recorder = new Recorder(path);
+};
 
-const runNext = pgConn =>{
-  if (pgConn[queueHead$] === null) return;
-  pgConn[queueHead$] = pgConn[queueHead$].next;
-  if (pgConn[queueHead$] !== null) {
-    const {func} = pgConn[queueHead$];
-    func();
-  } else
+PG.stopRecording = ()=>{
+  const r = recorder;
+  recorder = null;
+  return r === null ? Promise.resolve() : r.stop();
+};
+PG.parallelCopyTo = parallelCopy.parallelCopyTo;
+PG.parallelCopyFrom = parallelCopy.parallelCopyFrom;
+PG.lsnToString = lsnToString;
+PG.stats = PGLibPQ.globalStats;
+
+/* At most JOB_QUEUE_DEPTH in src/pg-libpq.h. */
+const MAX_QUEUE_DEPTH = 4;
+let queueDepth = MAX_QUEUE_DEPTH;
+
+/* A request starts once the one before it has completed, except that pipelined queries start
+   while earlier pipelined queries are still running, so the server works on the next one while the
+   previous result is converted. */
+const startQueued = pgConn =>{
+  for(;;) {
+    let running = 0, node = pgConn[queueHead$];
+    for(; node !== null && node.started; node = node.next) {
+      if (! node.pipelined) return;
+      ++running;
+    }
+    if (node === null || running !== 0 && (! node.pipelined || running >= queueDepth))
+      return;
+    node.started = true;
+    node.func(node);
+  }
+};
+
+/* node is the request that completed; one that failed before reaching the head is removed when
+   the head gets to it. */
+const runNext = (pgConn, node)=>{
+  const head = pgConn[queueHead$];
+  if (head === null) return;
+  if (node !== void 0 && node !== head) {
+    node.done = true;
+    return;
+  }
+  let next = head.next;
+  while (next !== null && next.done) next = next.next;
+  pgConn[queueHead$] = next;
+  if (next === null)
     pgConn[queueTail$] = null;
+  else
+    startQueued(pgConn);
 };
 
-const queueFunc = (pgConn, func)=>{
-  const node = {func: func, next: null};
-  if (pgConn[queueHead$] === null) {
+const queueFunc = (pgConn, func, pipelined=false)=>{
+  const node = {func, next: null, started: false, pipelined, done: false};
+  if (pgConn[queueHead$] === null)
     pgConn[queueHead$] = pgConn[queueTail$] = node;
-    func();
-  } else {
+  else {
     pgConn[queueTail$].next = node;
     pgConn[queueTail$] = node;
   }
+  startQueued(pgConn);
 };
 
-const promisify = (pgConn, callback, func)=>{
-  if (pgConn.isClosed()) throw connectionClosedError();
+const nsToMs = ns => Number(ns) / 1e6;
 
-  if (typeof callback === 'function') {
-    queueFunc(pgConn, ()=>{
-      const cb = handleCallback(pgConn, callback);
-      if (pgConn.isClosed())
-        cb(connectionClosedError());
-      else
-        func.call(pgConn, cb);
+const traceCallback = (pgConn, label, queuedAt, startTime, cb)=>{
+  const startedAt = process.hrtime.bigint();
+  return (err, result)=>{
+    const endedAt = process.hrtime.bigint();
+    const pq = pgConn[pq$];
+    const [wait, execute, handoff, convert, rows, bytes] =
+          pq === null ? [0, 0, 0, 0, 0, 0] : pq.lastTimings();
+    cb(err, result);
+    queryChannel.publish({
+      name: label, entryType: 'pg-libpq', startTime,
+      duration: nsToMs(endedAt - queuedAt),
+      detail: {
+        queue: nsToMs(startedAt - queuedAt),
+        wait: nsToMs(wait), execute: nsToMs(execute),
+        handoff: nsToMs(handoff), convert: nsToMs(convert),
+        rows, bytes, error: err || null,
+      },
     });
+  };
+};
+
+const RESULT_RAW = 1, RESULT_BINARY = 2;
+
+const resultOptions = (options, callback)=>{
+  if (typeof options === 'function') return [0, options];
+  if (options == null) return [0, callback];
+  return [(options.raw === true ? RESULT_RAW : 0) | (options.binary === true ? RESULT_BINARY : 0),
+          callback];
+};
+
+const cachedQuery = (pgConn, callback, options, keyParts, func, label, rec)=>{
+  const cache = options != null && typeof options === 'object' ? options.cache : void 0;
+  const key = cache === void 0 ? void 0 : ResultCache.key(...keyParts);
+  if (key === void 0) return promisify(pgConn, callback, func, label, rec, true);
+  if (pgConn.isClosed()) throw connectionClosedError();
+  const rows = cache.get(key);
+  if (rows !== void 0) {
+    if (typeof callback !== 'function') return Promise.resolve(rows);
+    process.nextTick(callback, null, rows);
     return;
   }
-  return new Promise((resolve, reject)=>{
-    queueFunc(pgConn, ()=>{
-      try {
-        const cb = handleCallback(pgConn, (err, result)=>{
-          if (err) reject(err);
-          else resolve(result);
-        });
-        if (pgConn.isClosed())
-          cb(connectionClosedError());
-        else func.call(pgConn, cb);
-      } catch(ex) {
-        reject(ex);
-      }
+  const generation = cache.generation;
+  return promisify(pgConn, callback, cb =>{
+    func((err, result)=>{
+      if (err == null && Array.isArray(result))
+        cache.set(key, result, pgConn[pq$].lastTimings()[5], options.tables, generation);
+      cb(err, result);
     });
-  });
+  }, label, rec, true);
 };
 
-const fetchError = (pgConn, err)=>{
-  let ex;
-  if (pgConn.isClosed()) {
-    ex = connectionClosedError();
-  } else try {
-    ex = err;
-    ex.sqlState = pgConn[pq$].resultErrorField(ERROR_FIELDS.SQLSTATE);
-  } catch(err) {
-    ex = err;
+let recorder = null;
+
+const promisify = (pgConn, callback, func, label, rec, pipelined)=>{
+  if (pgConn.isClosed()) throw connectionClosedError();
+
+  const recording = rec !== void 0 ? recorder : null;
+  const submittedAt = recording !== null ? process.hrtime.bigint() : 0n;
+
+  const traced = label !== void 0 && queryChannel !== null && queryChannel.hasSubscribers;
+  const queuedAt = traced ? process.hrtime.bigint() : 0n;
+  const startTime = traced ? performance.now() : 0;
+
+  const run = cb =>{
+    if (pgConn.isClosed())
+      cb(connectionClosedError());
+    else try {
+      if (pgConn[trace$] !== traced) {
+        pgConn[pq$].setTrace(traced);
+        pgConn[trace$] = traced;
+      }
+      if (recording !== null) cb = recording.wrap(pgConn, rec, submittedAt, cb);
+      func.call(pgConn, traced ? traceCallback(pgConn, label, queuedAt, startTime, cb) : cb);
+    } catch(ex) {
+      cb(ex);
+    }
+  };
+
+  if (typeof callback === 'function') {
+    queueFunc(pgConn, node =>{run(handleCallback(pgConn, callback, node))}, pipelined);
+    return;
   }
-  return ex;
+  return new Promise((resolve, reject)=>{
+    queueFunc(pgConn, node =>{
+      run(handleCallback(pgConn, (err, result)=>{
+        if (err) reject(err);
+        else resolve(result);
+      }, node));
+    }, pipelined);
+  });
 };
 
+/* The native side copies sqlState onto the error when the query completes; the last result may
+   by now belong to a later queued query so it is not consulted here. */
+const fetchError = (pgConn, err)=> pgConn.isClosed() ? connectionClosedError() : err;
 
-const handleCallback = (pgConn, callback)=>{
+
+const handleCallback = (pgConn, callback, node)=>{
   if (! callback) throw new Error("pg-libpq: Callback missing");
   return (err, result)=>{
     try {
-    runNext(pgConn);
+    runNext(pgConn, node);
     if (err) {
-      if (err.sqlState) {
-        callback(err);
-        return;
-      }
-      callback(fetchError(pgConn, err));
+      callback(err.sqlState ? err : fetchError(pgConn, err));
     } else {
-      if (Array.isArray(result)) {
-        const info = result[0], infolen = info.length, rows = result[1], rowlen = rows.length;
-        for(let j = 0; j < infolen; ++j) {
-          const meta = info[j];
-          const name = meta[0], oid = meta[1];
-          const converter = PARSERS[oid];
-          if (converter !== void 0) for(let i = 0; i < rowlen; ++i) {
-            const row = rows[i];
-            const v = row[name];
-            if (v !== void 0) {
-              if (typeof v === 'string') {
-                row[name] = converter(v);
-              } else {
-                if (Array.isArray(v)) {
-                  convertArray(v, converter);
-                } else {
-                  row[name] = converter(v);
-                }
-              }
-            }
-          }
-        }
-        callback(null, rows);
-      } else {
-        callback(null, result);
-      }
+      callback(null, result);
     }
     } catch(err) {
       console.error('Unhandled Error', err);
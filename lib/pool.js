@@ -0,0 +1,197 @@
+/* Connection sets over several hosts. Writes go to the host that is currently writable; read-only
+   requests go to the standby or read-only connection with the fewest outstanding requests. Hosts
+   are reclassified by periodic health checks and dropped while their connections fail. */
+
+const ROLE_SQL = "SELECT pg_is_in_recovery() AS standby, "+
+      "current_setting('transaction_read_only') = 'on' AS \"readOnly\"";
+
+const UNKNOWN = 'unknown', PRIMARY = 'primary', STANDBY = 'standby', DOWN = 'down';
+
+/* The native side flags errors raised once libpq reports the connection bad; other errors without
+   a SQLSTATE, such as parser exceptions, leave the client usable. */
+const isConnectionError = (err, client)=> err.connectionBad === true || client.isClosed() ||
+      /^(08|57P0[123])/.test(err.sqlState);
+
+const noHostError = readOnly =>{
+  const err = new Error(`no ${readOnly ? 'readable' : 'writable'} host available`);
+  err.sqlState = '08000';
+  return err;
+};
+
+class Host {
+  constructor(conninfo) {
+    this.conninfo = conninfo;
+    this.role = UNKNOWN;
+    this.clients = [];
+    this.failures = 0;
+    this.checking = null;
+    this.retryAt = 0;
+  }
+
+  get outstanding() {return this.clients.reduce((n, c)=> n + c.outstanding, 0)}
+}
+
+class Pool {
+  constructor({hosts=[''], size=4, healthInterval=5000, retryInterval=1000}={}) {
+    if (! Array.isArray(hosts) || hosts.length === 0)
+      throw new Error('hosts must be a non-empty array of conninfo strings');
+    if (! Number.isInteger(size) || size < 1)
+      throw new RangeError('size must be a positive integer');
+    this.hosts = hosts.map(conninfo => new Host(conninfo));
+    this.size = size;
+    this.retryInterval = retryInterval;
+    this.closed = false;
+    this.timer = healthInterval > 0 ? setInterval(()=>{this.checkHealth()}, healthInterval) : null;
+    if (this.timer !== null) this.timer.unref();
+  }
+
+  static async connect(options) {
+    const pool = new Pool(options);
+    await pool.checkHealth();
+    return pool;
+  }
+
+  checkHealth() {
+    return Promise.all(this.hosts.map(host => this.checkHost(host)));
+  }
+
+  checkHost(host) {
+    if (host.checking === null)
+      host.checking = this.probe(host).finally(()=>{host.checking = null});
+    return host.checking;
+  }
+
+  /* A failed top-up leaves the host running with fewer clients; the role check tries the clients
+     that are not suspect first and the host is only dropped when none of them answers. */
+  async probe(host) {
+    if (this.closed) return;
+    if (host.role === DOWN && Date.now() < host.retryAt) return;
+    if (host.clients.length < this.size) {
+      const PG = require('./pg-libpq');
+      try {
+        const added = await PG.connectMany(host.conninfo, this.size - host.clients.length);
+        for (const client of added) {
+          client.outstanding = 0;
+          client.suspect = false;
+        }
+        if (this.closed) return void added.forEach(c => c.finish());
+        host.clients.push(...added);
+      } catch(err) {}
+    }
+    const clients = host.clients.filter(c => ! c.suspect).concat(host.clients.filter(c => c.suspect));
+    for (const client of clients) {
+      try {
+        const [{standby, readOnly}] = await client.exec(ROLE_SQL);
+        host.role = standby || readOnly ? STANDBY : PRIMARY;
+        host.failures = 0;
+        return;
+      } catch(err) {
+        if (this.closed) return;
+        if (! isConnectionError(err, client)) continue;
+        const i = host.clients.indexOf(client);
+        if (i !== -1) host.clients.splice(i, 1);
+        client.finish();
+      }
+    }
+    this.dropHost(host);
+  }
+
+  dropHost(host) {
+    host.role = DOWN;
+    ++host.failures;
+    host.retryAt = Date.now() + this.retryInterval * Math.min(host.failures, 10);
+    for (const client of host.clients) client.finish();
+    host.clients = [];
+  }
+
+  pick(readOnly, exclude) {
+    let best = null, bestHost = null;
+    const consider = role =>{
+      for (const host of this.hosts) {
+        if (host.role !== role || host === exclude) continue;
+        for (const client of host.clients)
+          if (! client.suspect && (best === null || client.outstanding < best.outstanding)) {
+            best = client;
+            bestHost = host;
+          }
+      }
+    };
+    if (readOnly) consider(STANDBY);
+    if (best === null) consider(PRIMARY);
+    return best === null ? null : [bestHost, best];
+  }
+
+  async withClient({readOnly=false}={}, func, exclude=null) {
+    if (this.closed) throw new Error('pool is closed');
+    const picked = this.pick(readOnly, exclude);
+    if (picked === null) {
+      this.checkHealth();
+      throw noHostError(readOnly);
+    }
+    const [host, client] = picked;
+    ++client.outstanding;
+    try {
+      return await func(client);
+    } catch(err) {
+      if (isConnectionError(err, client)) {
+        err.host = host;
+        this.suspect(host, client);
+      }
+      throw err;
+    } finally {
+      --client.outstanding;
+    }
+  }
+
+  suspect(host, client) {
+    if (client.suspect) return;
+    client.suspect = true;
+    // exec throws at once if a probe already finished the client
+    (async ()=> client.exec('SELECT 1'))().then(()=>{client.suspect = false}, ()=>{
+      const i = host.clients.indexOf(client);
+      if (i === -1) return;
+      host.clients.splice(i, 1);
+      client.finish();
+      if (host.clients.length === 0)
+        this.dropHost(host);
+      else
+        this.checkHost(host);
+    });
+  }
+
+  async query(options, func) {
+    const readOnly = options != null && options.readOnly === true;
+    try {
+      return await this.withClient({readOnly}, func);
+    } catch(err) {
+      if (! readOnly || err.host === void 0 || this.closed) throw err;
+      return this.withClient({readOnly}, func, err.host);
+    }
+  }
+
+  exec(command, options) {
+    return this.query(options, client => client.exec(command, options));
+  }
+
+  execParams(command, params, options) {
+    return this.query(options, client => client.execParams(command, params, options));
+  }
+
+  status() {
+    return this.hosts.map(h =>({
+      conninfo: h.conninfo, role: h.role, connections: h.clients.length,
+      outstanding: h.outstanding,
+    }));
+  }
+
+  end() {
+    this.closed = true;
+    if (this.timer !== null) clearInterval(this.timer);
+    for (const host of this.hosts) {
+      for (const client of host.clients) client.finish();
+      host.clients = [];
+    }
+  }
+}
+
+module.exports = Pool;
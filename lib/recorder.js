@@ -0,0 +1,182 @@
+const fs = require('fs');
+const readline = require('readline');
+const {performance} = require('perf_hooks');
+
+/* One JSON array per line:
+   [connection, submittedMs, latencyMs, kind, text, params, failed]
+   kind is q (exec/execParams), p (prepare; params is the command), e (execPrepared) or
+   b (execPreparedBatch; params is the array of param sets). */
+
+const nsToMs = ns => +(Number(ns) / 1e6).toFixed(3);
+
+const encodeParam = value =>{
+  if (value === void 0) return null;
+  if (Buffer.isBuffer(value)) return {b: value.toString('base64')};
+  if (ArrayBuffer.isView(value))
+    return {b: Buffer.from(value.buffer, value.byteOffset, value.byteLength).toString('base64')};
+  if (typeof value === 'bigint') return {n: value.toString()};
+  if (value instanceof Date) return {d: value.toISOString()};
+  if (value !== null && typeof value === 'object') return {j: value};
+  return value;
+};
+
+const decodeParam = value =>{
+  if (value === null || typeof value !== 'object') return value;
+  if (value.b !== void 0) return Buffer.from(value.b, 'base64');
+  if (value.n !== void 0) return BigInt(value.n);
+  if (value.d !== void 0) return new Date(value.d);
+  return value.j;
+};
+
+const encodeParams = (kind, params)=>{
+  if (kind === 'p' || params == null) return params;
+  return kind === 'b' ? params.map(set => set.map(encodeParam)) : params.map(encodeParam);
+};
+
+const decodeParams = (kind, params)=>{
+  if (kind === 'p' || params == null) return params;
+  return kind === 'b' ? params.map(set => set.map(decodeParam)) : params.map(decodeParam);
+};
+
+class Recorder {
+  constructor(path) {
+    this.out = fs.createWriteStream(path);
+    this.out.on('error', err =>{this.error = err});
+    this.error = null;
+    this.start = process.hrtime.bigint();
+    this.ids = new WeakMap();
+    this.connections = 0;
+    this.stopped = false;
+  }
+
+  wrap(pgConn, [kind, text, params], submitted, cb) {
+    let id = this.ids.get(pgConn);
+    if (id === void 0) this.ids.set(pgConn, id = ++this.connections);
+    const line = [id, nsToMs(submitted - this.start), 0, kind, text, encodeParams(kind, params), 0];
+    return (err, result)=>{
+      if (! this.stopped) {
+        line[2] = nsToMs(process.hrtime.bigint() - submitted);
+        if (err != null) line[6] = 1;
+        this.out.write(JSON.stringify(line)+'\n');
+      }
+      cb(err, result);
+    };
+  }
+
+  stop() {
+    this.stopped = true;
+    return new Promise((resolve, reject)=>{
+      this.out.end(()=>{this.error === null ? resolve() : reject(this.error)});
+    });
+  }
+}
+
+const readRecording = async path =>{
+  const entries = [];
+  const lines = readline.createInterface({input: fs.createReadStream(path), crlfDelay: Infinity});
+  for await (const line of lines) {
+    if (line === '') continue;
+    let [conn, at, ms, kind, text, params, failed] = JSON.parse(line);
+    params = decodeParams(kind, params);
+    entries.push({conn, at, ms, kind, text, params, failed: failed === 1});
+  }
+  return entries.sort((a, b)=> a.at - b.at);
+};
+
+const percentile = (sorted, p)=> sorted.length === 0
+      ? 0 : sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+
+const summary = (entries, start, latency)=>{
+  const times = entries.map(latency).sort((a, b)=> a - b);
+  let first = Infinity, last = -Infinity;
+  for (const e of entries) {
+    first = Math.min(first, start(e));
+    last = Math.max(last, start(e) + latency(e));
+  }
+  const durationMs = +(last - first).toFixed(3);
+  return {
+    durationMs,
+    qps: Math.round(entries.length / (durationMs / 1000)),
+    meanMs: +(times.reduce((s, t)=> s + t, 0) / times.length).toFixed(3),
+    p50Ms: percentile(times, 0.5), p95Ms: percentile(times, 0.95), p99Ms: percentile(times, 0.99),
+  };
+};
+
+const issue = (pg, {kind, text, params})=>{
+  switch (kind) {
+  case 'q': return params == null ? pg.exec(text) : pg.execParams(text, params);
+  case 'p': return pg.prepare(text, params);
+  case 'e': return pg.execPrepared(text, params);
+  case 'b': return pg.execPreparedBatch(text, params);
+  }
+  return Promise.reject(new Error(`unknown kind: ${kind}`));
+};
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+/* Re-issue a recording with one connection per recorded connection. With speed > 0 each statement
+   is submitted at its recorded time divided by speed; with speed 0 each connection runs its
+   statements back to back. */
+const replay = async (path, {conninfo, speed=1}={})=>{
+  const PG = require('./pg-libpq');
+  const entries = await readRecording(path);
+  if (entries.length === 0) throw new Error('empty recording');
+  const byConn = new Map();
+  for (const e of entries) {
+    if (! byConn.has(e.conn)) byConn.set(e.conn, []);
+    byConn.get(e.conn).push(e);
+  }
+  const clients = await PG.connectMany(conninfo, byConn.size);
+  const offset = entries[0].at;
+  let errors = 0;
+  const started = performance.now();
+  try {
+    await Promise.all([...byConn.values()].map(async (list, i)=>{
+      const pg = clients[i];
+      const pending = [];
+      for (const e of list) {
+        if (speed > 0) {
+          const wait = (e.at - offset) / speed - (performance.now() - started);
+          if (wait > 1) await sleep(wait);
+        }
+        const start = performance.now();
+        const run = issue(pg, e).catch(()=>{++errors}).then(()=>{
+          e.replayStart = start - started;
+          e.replayMs = +(performance.now() - start).toFixed(3);
+        });
+        if (speed > 0) pending.push(run); else await run;
+      }
+      await Promise.all(pending);
+    }));
+  } finally {
+    for (const pg of clients) pg.finish();
+  }
+
+  const statements = new Map();
+  for (const e of entries) {
+    const key = e.kind+' '+e.text;
+    let s = statements.get(key);
+    if (s === void 0)
+      statements.set(key, s = {kind: e.kind, text: e.text, count: 0, original: 0, replay: 0});
+    ++s.count;
+    s.original += e.ms;
+    s.replay += e.replayMs;
+  }
+  const original = summary(entries, e => e.at, e => e.ms);
+  const replayed = summary(entries, e => e.replayStart, e => e.replayMs);
+  return {
+    entries: entries.length,
+    connections: byConn.size,
+    speed,
+    errors: {original: entries.filter(e => e.failed).length, replay: errors},
+    original, replay: replayed,
+    statements: [...statements.values()].sort((a, b)=> b.original - a.original).map(s =>({
+      kind: s.kind, text: s.text, count: s.count,
+      originalMeanMs: +(s.original / s.count).toFixed(3),
+      replayMeanMs: +(s.replay / s.count).toFixed(3),
+      changePct: s.original === 0 ? 0 : +((s.replay - s.original) / s.original * 100).toFixed(1),
+    })),
+  };
+};
+
+module.exports = {Recorder, readRecording, replay};
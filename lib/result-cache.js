@@ -0,0 +1,145 @@
+/* Follows the type switch of encodeValue in src/encode.h, so values only share a key when they
+   are of the same kind and encode to the same text. Returns undefined for params that cannot be
+   keyed safely, such as ones whose encoding throws; queries with those are not cached. */
+const paramKey = value =>{
+  if (value == null) return '\u0000';
+  switch(typeof value) {
+  case 'string': return 's'+value;
+  case 'number': return 'n'+(Object.is(value, -0) ? '-0' : value);
+  case 'boolean': return 'b'+value;
+  // bigint is 'i' since 'b' is boolean
+  case 'bigint': return 'i'+value;
+  case 'object': break;
+  default: return void 0;
+  }
+  if (Buffer.isBuffer(value)) return 'x'+value.toString('hex');
+  if (ArrayBuffer.isView(value) && ! (value instanceof DataView))
+    return 'v'+Object.prototype.toString.call(value).slice(8, -1)+':'+
+      Buffer.from(value.buffer, value.byteOffset, value.byteLength).toString('hex');
+  if (value instanceof Date) return isNaN(value.getTime()) ? void 0 : 'd'+value.toISOString();
+  if (Array.isArray(value)) {
+    const keys = value.map(paramKey);
+    return keys.includes(void 0) ? void 0 : 'a'+JSON.stringify(keys);
+  }
+  try {
+    const json = JSON.stringify(value);
+    return json === void 0 ? '\u0000' : 'o'+json;
+  } catch(err) {
+    return void 0;
+  }
+};
+
+/* Freezes rows and the objects and arrays inside them, such as parsed json. Buffer and Date cells
+   cannot be frozen; they are shared by every hit and must not be mutated. */
+const deepFreeze = value =>{
+  if (value === null || typeof value !== 'object' || Object.isFrozen(value) ||
+      ArrayBuffer.isView(value) || value instanceof Date)
+    return value;
+  Object.freeze(value);
+  for (const key of Object.keys(value)) deepFreeze(value[key]);
+  return value;
+};
+
+const freezeRows = rows => deepFreeze(rows);
+
+class ResultCache {
+  constructor({maxEntries=1000, maxBytes=64 << 20, ttl=1000}={}) {
+    if (! Number.isInteger(maxEntries) || maxEntries < 1)
+      throw new RangeError('maxEntries must be a positive integer');
+    this.maxEntries = maxEntries;
+    this.maxBytes = maxBytes;
+    this.ttl = ttl;
+    this.bytes = 0;
+    this.hits = this.misses = 0;
+    this.generation = 0;
+    this.entries = new Map();
+    this.tables = new Map();
+  }
+
+  /* Returns undefined when a param cannot be keyed. */
+  static key(kind, text, params, mode) {
+    let key = kind+mode+'\u0000'+text;
+    if (params != null) for (const p of params) {
+      const pk = paramKey(p);
+      if (pk === void 0) return void 0;
+      key += '\u0000'+pk;
+    }
+    return key;
+  }
+
+  get size() {return this.entries.size}
+
+  get(key) {
+    const entry = this.entries.get(key);
+    if (entry === void 0 || entry.expires <= Date.now()) {
+      if (entry !== void 0) this.delete(key);
+      ++this.misses;
+      return void 0;
+    }
+    ++this.hits;
+    this.entries.delete(key);
+    this.entries.set(key, entry);
+    return entry.rows;
+  }
+
+  set(key, rows, bytes, tables=[], generation=this.generation) {
+    if (bytes > this.maxBytes || generation !== this.generation) return rows;
+    this.delete(key);
+    this.entries.set(key, {rows: freezeRows(rows), bytes, tables, expires: Date.now() + this.ttl});
+    this.bytes += bytes;
+    for (const table of tables) {
+      const keys = this.tables.get(table);
+      if (keys === void 0)
+        this.tables.set(table, new Set([key]));
+      else
+        keys.add(key);
+    }
+    for (const oldest of this.entries.keys()) {
+      if (this.entries.size <= this.maxEntries && this.bytes <= this.maxBytes) break;
+      this.delete(oldest);
+    }
+    return rows;
+  }
+
+  delete(key) {
+    const entry = this.entries.get(key);
+    if (entry === void 0) return;
+    this.entries.delete(key);
+    this.bytes -= entry.bytes;
+    for (const table of entry.tables) {
+      const keys = this.tables.get(table);
+      keys.delete(key);
+      if (keys.size === 0) this.tables.delete(table);
+    }
+  }
+
+  invalidate(table) {
+    if (table === void 0 || table === '') return this.clear();
+    ++this.generation;
+    const keys = this.tables.get(table);
+    if (keys !== void 0) for (const key of keys) this.delete(key);
+  }
+
+  clear() {
+    ++this.generation;
+    this.entries.clear();
+    this.tables.clear();
+    this.bytes = 0;
+  }
+
+  async listen(client, channel) {
+    await client.exec(`LISTEN "${channel.replace(/"/g, '""')}"`);
+    this.clear();
+    (async ()=>{
+      try {
+        while (! client.isClosed()) {
+          for (const {channel: name, payload} of await client.waitForNotify())
+            if (name === channel) this.invalidate(payload);
+        }
+      } catch(err) {}
+      this.clear();
+    })();
+  }
+}
+
+module.exports = ResultCache;
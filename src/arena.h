@@ -0,0 +1,135 @@
+#ifdef _MSC_VER
+#include <intrin.h>
+#define atomicAdd(ptr, n) _InterlockedExchangeAdd64((volatile __int64*)(ptr), n)
+#define atomicGet(ptr) _InterlockedCompareExchange64((volatile __int64*)(ptr), 0, 0)
+#define atomicSet(ptr, v) _InterlockedExchange64((volatile __int64*)(ptr), v)
+#define atomicCas(ptr, expected, desired)                               \
+  (_InterlockedCompareExchange64((volatile __int64*)(ptr), desired, expected) == (expected))
+#else
+#define atomicAdd(ptr, n) __atomic_fetch_add(ptr, n, __ATOMIC_RELAXED)
+#define atomicGet(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define atomicSet(ptr, v) __atomic_store_n(ptr, v, __ATOMIC_RELEASE)
+static inline bool atomicCas(int64_t* ptr, int64_t expected, int64_t desired) {
+  return __atomic_compare_exchange_n(ptr, &expected, desired, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#endif
+
+static int64_t allocCount, freeCount, allocBytes, arenaBytes;
+
+static void* countedMalloc(size_t size) {
+  atomicAdd(&allocCount, 1);
+  atomicAdd(&allocBytes, (int64_t)size);
+  return malloc(size);
+}
+
+static void* countedCalloc(size_t n, size_t size) {
+  atomicAdd(&allocCount, 1);
+  atomicAdd(&allocBytes, (int64_t)(n*size));
+  return calloc(n, size);
+}
+
+static void* countedRealloc(void* ptr, size_t size) {
+  atomicAdd(&allocCount, 1);
+  atomicAdd(&allocBytes, (int64_t)size);
+  if (ptr != NULL) atomicAdd(&freeCount, 1);
+  return realloc(ptr, size);
+}
+
+static void countedFree(void* ptr) {
+  if (ptr == NULL) return;
+  atomicAdd(&freeCount, 1);
+  free(ptr);
+}
+
+#define ARENA_ALIGN 8
+#define ARENA_MIN_CHUNK 4096
+
+typedef struct ArenaChunk ArenaChunk;
+
+struct ArenaChunk {
+  ArenaChunk* next;
+  size_t size;
+  size_t used;
+  char data[];
+};
+
+typedef struct {
+  ArenaChunk* head;
+  size_t total;
+} Arena;
+
+static ArenaChunk* arenaAddChunk(Arena* arena, size_t size) {
+  if (size < ARENA_MIN_CHUNK) size = ARENA_MIN_CHUNK;
+  if (arena->head != NULL && size < arena->head->size*2) size = arena->head->size*2;
+  ArenaChunk* chunk = countedMalloc(sizeof(ArenaChunk) + size);
+  chunk->next = arena->head;
+  chunk->size = size;
+  chunk->used = 0;
+  arena->head = chunk;
+  arena->total += size;
+  atomicAdd(&arenaBytes, (int64_t)size);
+  return chunk;
+}
+
+static void* arenaAlloc(Arena* arena, size_t size) {
+  size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  ArenaChunk* chunk = arena->head;
+  if (chunk == NULL || chunk->used + size > chunk->size)
+    chunk = arenaAddChunk(arena, size);
+  void* result = chunk->data + chunk->used;
+  chunk->used += size;
+  return result;
+}
+
+static void* arenaCalloc(Arena* arena, size_t size) {
+  return memset(arenaAlloc(arena, size), 0, size);
+}
+
+/* Resize the allocation ptr of oldSize; extended in place when it is the last allocation. */
+static void* arenaGrow(Arena* arena, void* ptr, size_t oldSize, size_t size) {
+  ArenaChunk* chunk = arena->head;
+  if (ptr != NULL && chunk != NULL && (char*)ptr + oldSize == chunk->data + chunk->used) {
+    size_t start = (char*)ptr - chunk->data;
+    if (start + size <= chunk->size) {
+      chunk->used = start + size;
+      return ptr;
+    }
+  }
+  void* result = arenaAlloc(arena, size);
+  if (oldSize != 0) memcpy(result, ptr, oldSize);
+  return result;
+}
+
+static void arenaFree(Arena* arena) {
+  ArenaChunk* chunk = arena->head;
+  while (chunk != NULL) {
+    ArenaChunk* next = chunk->next;
+    atomicAdd(&arenaBytes, -(int64_t)chunk->size);
+    countedFree(chunk);
+    chunk = next;
+  }
+  arena->head = NULL;
+  arena->total = 0;
+}
+
+/* Release everything allocated; the memory is kept, coalesced into one chunk, for reuse. */
+static void arenaReset(Arena* arena) {
+  if (arena->head == NULL) return;
+  if (arena->head->next != NULL) {
+    size_t total = arena->total;
+    arenaFree(arena);
+    arenaAddChunk(arena, total);
+  } else {
+    arena->head->used = 0;
+  }
+}
+
+static char* _arenaGetString(napi_env env, Arena* arena, napi_value src) {
+  size_t len;
+  assertok(napi_get_value_string_utf8(env, src, NULL, 0, &len));
+  char* dest = arenaAlloc(arena, len+1);
+  assertok(napi_get_value_string_utf8(env, src, dest, len+1, &len));
+  return dest;
+}
+#define arenaGetString(arena, value) _arenaGetString(env, arena, value)
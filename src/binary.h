@@ -0,0 +1,102 @@
+/* Cells of results requested in binary format. Types without a decoder here, bytea included,
+   become Buffers viewing the PGresult, which is cleared when its last view is collected. */
+
+typedef struct ResultHold {
+  PGresult* result;
+  int64_t size;
+  int refs;
+} ResultHold;
+
+static ResultHold* holdResult(PGresult* result, int64_t size) {
+  ResultHold* hold = countedMalloc(sizeof(ResultHold));
+  hold->result = result;
+  hold->size = size;
+  hold->refs = 1;
+  return hold;
+}
+
+static void releaseHold(ResultHold* hold) {
+  if (--hold->refs != 0) return;
+  atomicAdd(&resultBytes, -hold->size);
+  PQclear(hold->result);
+  countedFree(hold);
+}
+
+static void finalizeView(napi_env env, void* data, void* hint) {
+  releaseHold(hint);
+}
+
+static napi_value makeView(napi_env env, ResultHold* hold, char* data, int len) {
+  napi_value result = NULL;
+  if (len != 0 &&
+      napi_create_external_buffer(env, len, data, finalizeView, hold, &result) == napi_ok) {
+    ++hold->refs;
+    return result;
+  }
+  return jsok(napi_create_buffer_copy(env, len, data, NULL, &result)) ? result : NULL;
+}
+
+static uint32_t readUint32(const char* data) {
+  const u_char* b = (const u_char*)data;
+  return (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+}
+
+static uint64_t readUint64(const char* data) {
+  return (uint64_t)readUint32(data) << 32 | readUint32(data + 4);
+}
+
+/* The same range as the text format's MAX_INT_LEN digits. */
+#define MIN_INT8_NUMBER -99999999999999LL
+#define MAX_INT8_NUMBER 999999999999999LL
+
+static napi_value convertNumber(napi_env env, Oid type, char* data, int len) {
+  switch(type) {
+  case 16: return len == 1 ? makeBoolean(data[0] != 0) : NULL;
+  case 21: return len == 2 ? makeInt((int16_t)((u_char)data[0] << 8 | (u_char)data[1])) : NULL;
+  case 23: return len == 4 ? makeInt((int32_t)readUint32(data)) : NULL;
+  case 26: return len == 4 ? makeInt(readUint32(data)) : NULL;
+  case 20: {
+    if (len != 8) return NULL;
+    const int64_t value = (int64_t)readUint64(data);
+    if (value < MIN_INT8_NUMBER || value > MAX_INT8_NUMBER) {
+      char buf[24];
+      return makeString(buf, sprintf(buf, "%lld", (long long)value));
+    }
+    return makeInt(value);
+  }
+  case 700: {
+    if (len != 4) return NULL;
+    const uint32_t bits = readUint32(data);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return makeDouble(value);
+  }
+  case 701: {
+    if (len != 8) return NULL;
+    const uint64_t bits = readUint64(data);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return makeDouble(value);
+  }
+  }
+  return NULL;
+}
+
+/* Decoded values go through the registered parser as in text format; views do not, since a
+   parser expects the text format's value. */
+static napi_value convertBinary(napi_env env, ResultHold* hold, Oid type,
+                                TypeConverter* tc, napi_value parser, char* data, int len) {
+  switch(type) {
+  case 3802:
+    if (len > 0 && data[0] == 1)
+      return convertCell(env, tc, parser, data + 1, len - 1);
+    break;
+  case 18: case 19: case 25: case 114: case 142: case 705: case 1042: case 1043:
+    return convertCell(env, tc, parser, data, len);
+  default: {
+    napi_value value = convertNumber(env, type, data, len);
+    if (value != NULL) return applyParser(env, parser, value);
+  }
+  }
+  return makeView(env, hold, data, len);
+}
@@ -14,16 +14,34 @@ static napi_value convertDouble(napi_env env,  char *text, int len) {
   return makeDouble(atof(text));
 }
 
+/* Check eight bytes at a time for a high bit; pure ASCII can skip UTF-8 decoding. */
+static bool isAscii(const char *text, int len) {
+  const uint64_t high = 0x8080808080808080ULL;
+  uint64_t acc = 0, word;
+  int i = 0;
+  for(; i + 32 <= len; i += 32) {
+    uint64_t w0, w1, w2, w3;
+    memcpy(&w0, text+i, 8); memcpy(&w1, text+i+8, 8);
+    memcpy(&w2, text+i+16, 8); memcpy(&w3, text+i+24, 8);
+    if ((w0 | w1 | w2 | w3) & high) return false;
+  }
+  for(; i + 8 <= len; i += 8) {
+    memcpy(&word, text+i, 8);
+    acc |= word;
+  }
+  for(; i < len; ++i) acc |= (u_char)text[i];
+  return (acc & high) == 0;
+}
+
 static napi_value convertText(napi_env env,  char *text, int len) {
-  napi_value result;
-  assertok(napi_create_string_utf8(env, text, len, &result));
+  napi_value result = NULL;
+  if (isAscii(text, len))
+    assertok(napi_create_string_latin1(env, text, len, &result));
+  else
+    assertok(napi_create_string_utf8(env, text, len, &result));
   return result;
 }
 
-static struct tm tm;
-static int* tm_parts[] = {&tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-                          &tm.tm_hour, &tm.tm_min, &tm.tm_sec};
-
 static int read_tm_part(char *text, int len, int pos, int *result) {
   register int npos = pos;
   register char c;
@@ -40,13 +58,13 @@ static char * POSITIVE_INFINITY = "Infinity";
 static char * NEGATIVE_INFINITY = "NEGATIVE_INFINITY";
 
 static napi_value get_global_prop(napi_env env, char *name) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_get_named_property(env, getGlobal(), name, &result));
   return result;
 }
 
 static napi_value get_number_prop(napi_env env, char *name) {
-  napi_value number, result;
+  napi_value number = NULL, result = NULL;
 
   assertok(napi_get_named_property(env, getGlobal(), Number, &number));
 
@@ -55,12 +73,10 @@ static napi_value get_number_prop(napi_env env, char *name) {
   return result;
 }
 
-static napi_value convertDate(napi_env env,  char *text, int len) {
-  if (text[0] == 'i') return get_global_prop(env, POSITIVE_INFINITY);
-  if (text[0] == '-' && text[1] == 'i') return get_number_prop(env, NEGATIVE_INFINITY);
-
-  if (sizeof(time_t) != 8) return convertText(env, text, len);
-
+static double dateToMs(char *text, int len) {
+  struct tm tm;
+  int* tm_parts[] = {&tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                     &tm.tm_hour, &tm.tm_min, &tm.tm_sec};
   register int i = 0, pos = 0, npos = 0;
   for(; i < 6; ++i) {
     npos = read_tm_part(text, len, pos, tm_parts[i]);
@@ -106,7 +122,24 @@ static napi_value convertDate(napi_env env,  char *text, int len) {
 
   tm.tm_isdst = 0;
   double time = (double)timegm(&tm);
-  return makeDouble(time*1000 + (double)ms);
+  return time*1000 + (double)ms;
+}
+
+/* Milliseconds since the epoch, or +-Infinity; what registered date parsers are given. */
+static napi_value convertDateMs(napi_env env,  char *text, int len) {
+  if (text[0] == 'i') return get_global_prop(env, POSITIVE_INFINITY);
+  if (text[0] == '-' && text[1] == 'i') return get_number_prop(env, NEGATIVE_INFINITY);
+
+  if (sizeof(time_t) != 8) return convertText(env, text, len);
+
+  return makeDouble(dateToMs(text, len));
+}
+
+static napi_value convertDate(napi_env env,  char *text, int len) {
+  if (text[0] == 'i' || (text[0] == '-' && text[1] == 'i') || sizeof(time_t) != 8)
+    return convertDateMs(env, text, len);
+
+  return makeDate(dateToMs(text, len));
 }
 
 static u_char htod(char h) {
@@ -115,10 +148,10 @@ static u_char htod(char h) {
 
 static napi_value convertBytea(napi_env env, char *text, int len) {
   size_t i;
-  size_t size = (len >> 1)-1;
+  size_t size = len < 2 ? 0 : (len >> 1)-1;
   u_char* data;
-  napi_value result;
-  assertok(napi_create_buffer(env, size, (void**)&data, &result));
+  napi_value result = NULL;
+  if (! jsok(napi_create_buffer(env, size, (void**)&data, &result))) return NULL;
 
   for(i = 0; i < size; ++i) {
     data[i] = (u_char)(htod(text[i*2+2])*16 + htod(text[i*2+3]));
@@ -134,14 +167,23 @@ static int unQuote(char *text, int len) {
   return src;
 }
 
+static napi_value applyParser(napi_env env, napi_value parser, napi_value value) {
+  if (parser == NULL) return value;
+  napi_value result = NULL;
+  if (napi_call_function(env, getGlobal(), parser, 1, &value, &result) != napi_ok)
+    return NULL;
+  return result;
+}
+
 typedef struct {
   napi_value result;
   int pos;
 } arrayAndPos;
 
-static arrayAndPos _convertArray(napi_env env, transformer t, char *text, int len) {
+static arrayAndPos _convertArray(napi_env env, transformer t, napi_value parser, char delim,
+                                 char *text, int len) {
   int ep;
-  napi_value result;
+  napi_value result, value;
   const napi_value nullv = getNull();
   char *word;
   int wlen;
@@ -165,81 +207,397 @@ static arrayAndPos _convertArray(napi_env env, transformer t, char *text, int le
           word = text+pos;
           wlen = unQuote(text+pos, ep-pos);
           pos = ep+1;
-          addValue(result, wc++, t(env, word, wlen));
+          value = applyParser(env, parser, t(env, word, wlen));
+          if (value == NULL) goto fail;
+          addValue(result, wc++, value);
           break;
         }
       }
+      if (ep >= len) goto end;
     } else {
       for(ep = pos; ep < len; ++ep) {
         c = text[ep];
-        if (c == ',' || c == '}') {
+        if (c == delim || c == '}') {
           word = text+pos; wlen = ep-pos;
-          addValue(result, wc++,
-                   strncmp("NULL", word, wlen) == 0 ? nullv : t(env, word, wlen));
+          if (strncmp("NULL", word, wlen) == 0)
+            value = nullv;
+          else {
+            value = applyParser(env, parser, t(env, word, wlen));
+            if (value == NULL) goto fail;
+          }
+          addValue(result, wc++, value);
           pos = ep+1;
           if (c == '}') goto end;
           break;
         }
         if (c == '{') {
-          arrayAndPos ans = _convertArray(env, t, text+ep, len-ep);
+          arrayAndPos ans = _convertArray(env, t, parser, delim, text+ep, len-ep);
+          if (ans.result == NULL) return ans;
           addValue(result, wc++, ans.result);
           pos = ep+ans.pos+1;
           break;
         }
       }
+      if (ep >= len) goto end;
     }
   }
  end:;
   arrayAndPos ans = {result, pos};
   return ans;
+ fail:;
+  arrayAndPos failed = {NULL, pos};
+  return failed;
 }
 
-static napi_value convertArray(napi_env env, transformer t, char *text, int len) {
-  return _convertArray(env, t, text, len).result;
+#define PGLIBPQ_MODE_TEXT 0
+#define PGLIBPQ_MODE_NUMBER 1
+#define PGLIBPQ_MODE_OBJECT 2
+#define PGLIBPQ_MODE_BUFFER 3
+
+#define MODE_BIT(mode) (1 << PGLIBPQ_MODE_ ## mode)
+
+typedef struct {
+  Oid oid;
+  Oid arrayOid;
+  char mode;
+  char allowed;
+} TypeMode;
+
+enum {
+  TM_UUID, TM_NUMERIC, TM_MONEY, TM_INTERVAL, TM_INET, TM_CIDR,
+  TM_POINT, TM_BOX, TM_TSRANGE, TM_TSTZRANGE, TM_DATERANGE, TM_COUNT
+};
+
+static const TypeMode typeModeDefaults[TM_COUNT] = {
+  {2950, 2951, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(BUFFER)},
+  {1700, 1231, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(NUMBER)},
+  {790, 791, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(NUMBER)},
+  {1186, 1187, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+  {869, 1041, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+  {650, 651, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+  {600, 1017, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+  {603, 1020, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+  {3908, 3909, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+  {3910, 3911, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+  {3912, 3913, PGLIBPQ_MODE_TEXT, MODE_BIT(TEXT) | MODE_BIT(OBJECT)},
+};
+
+/* The mode chosen for each TypeMode entry; kept per napi_env since workers set them separately. */
+typedef struct {
+  char mode[TM_COUNT];
+} TypeModes;
+
+static void initTypeModes(TypeModes* modes) {
+  for(int i = 0; i < TM_COUNT; ++i) modes->mode[i] = typeModeDefaults[i].mode;
+}
+
+static int findTypeMode(Oid oid) {
+  for(int i = 0; i < TM_COUNT; ++i) {
+    if (typeModeDefaults[i].oid == oid || typeModeDefaults[i].arrayOid == oid)
+      return i;
+  }
+  return -1;
+}
+
+/* The converters below are only chosen when their type is not in PGLIBPQ_MODE_TEXT. */
+
+static napi_value convertUuid(napi_env env, char *text, int len) {
+  if (len != 36)
+    return convertText(env, text, len);
+
+  u_char* data;
+  napi_value result = NULL;
+  if (! jsok(napi_create_buffer(env, 16, (void**)&data, &result))) return NULL;
+  for(int i = 0, j = 0; i < 16; ++i, j += 2) {
+    if (text[j] == '-') ++j;
+    if (j+1 >= len) break;
+    data[i] = (u_char)(htod(text[j])*16 + htod(text[j+1]));
+  }
+  return result;
 }
 
-static napi_value convert(napi_env env, Oid type, char *text, int len) {
+static napi_value convertNumeric(napi_env env, char *text, int len) {
+  return makeDouble(strtod(text, NULL));
+}
+
+/* Reads the C and en_US lc_monetary format, such as -$1,234.56 or ($1,234.56). Other formats,
+   with another currency symbol, grouping or decimal point, are left as text. */
+static napi_value convertMoney(napi_env env, char *text, int len) {
+  char buf[64];
+  int i = 0, j = 0, digits = 0, group = -1;
+  bool neg = false, paren = false;
+  if (i < len && (text[i] == '-' || text[i] == '(')) {
+    neg = true;
+    paren = text[i++] == '(';
+  }
+  if (i < len && text[i] == '$') ++i;
+  for(; i < len && j < 60; ++i) {
+    const char c = text[i];
+    if (c >= '0' && c <= '9') {
+      buf[j++] = c;
+      ++digits;
+      if (group != -1) ++group;
+    } else if (c == ',' && (group == -1 ? digits > 0 && digits <= 3 : group == 3))
+      group = 0;
+    else
+      break;
+  }
+  if (digits == 0 || (group != -1 && group != 3)) return convertText(env, text, len);
+  if (i < len && text[i] == '.') {
+    buf[j++] = text[i++];
+    const int start = i;
+    for(; i < len && j < 63 && text[i] >= '0' && text[i] <= '9'; ++i) buf[j++] = text[i];
+    if (i == start) return convertText(env, text, len);
+  }
+  if (paren && (i == len || text[i++] != ')')) return convertText(env, text, len);
+  if (i != len) return convertText(env, text, len);
+  buf[j] = 0;
+  const double value = strtod(buf, NULL);
+  return makeDouble(neg ? -value : value);
+}
+
+static const char* intervalFields[] = {
+  "years", "months", "days", "hours", "minutes", "seconds", "milliseconds"
+};
+
+static napi_value convertInterval(napi_env env, char *text, int len) {
+  double parts[7] = {0, 0, 0, 0, 0, 0, 0};
+  int pos = 0;
+  while (pos < len) {
+    if (text[pos] == ' ') {++pos; continue;}
+    double sign = 1;
+    if (text[pos] == '-' || text[pos] == '+') {
+      if (text[pos] == '-') sign = -1;
+      ++pos;
+    }
+    int value, npos = read_tm_part(text, len, pos, &value);
+    if (npos == pos) goto bad;
+    if (npos < len && text[npos] == ':') {
+      int mins, secs, frac = 0;
+      pos = read_tm_part(text, len, npos+1, &mins);
+      if (pos >= len || text[pos] != ':') goto bad;
+      npos = read_tm_part(text, len, pos+1, &secs);
+      double us = 0;
+      if (npos < len && text[npos] == '.') {
+        pos = read_tm_part(text, len, npos+1, &frac);
+        us = frac;
+        for(int d = pos - npos - 1; d < 6; ++d) us *= 10;
+        npos = pos;
+      }
+      parts[3] += sign*value;
+      parts[4] += sign*mins;
+      parts[5] += sign*secs;
+      parts[6] += sign*us/1000;
+      pos = npos;
+      continue;
+    }
+    if (npos+1 >= len || text[npos] != ' ') goto bad;
+    pos = npos+1;
+    switch(text[pos]) {
+    case 'y': parts[0] += sign*value; break;
+    case 'm': parts[1] += sign*value; break;
+    case 'd': parts[2] += sign*value; break;
+    default: goto bad;
+    }
+    while (pos < len && text[pos] != ' ') ++pos;
+  }
+
+  napi_value result = makeObject();
+  for(int i = 0; i < 7; ++i)
+    setProperty(result, intervalFields[i], makeDouble(parts[i]));
+  return result;
+
+ bad:
+  return convertText(env, text, len);
+}
+
+static napi_value convertInet(napi_env env, char *text, int len) {
+  int slash = 0;
+  bool ipv6 = false;
+  for(; slash < len && text[slash] != '/'; ++slash)
+    if (text[slash] == ':') ipv6 = true;
+
+  int prefix = ipv6 ? 128 : 32;
+  if (slash < len) read_tm_part(text, len, slash+1, &prefix);
+
+  napi_value result = makeObject();
+  setProperty(result, "address", makeString(text, slash));
+  setProperty(result, "prefix", makeInt(prefix));
+  return result;
+}
+
+static napi_value makePoint(napi_env env, char *text, char **end) {
+  napi_value result = makeObject();
+  setProperty(result, "x", makeDouble(strtod(text+1, end)));
+  setProperty(result, "y", makeDouble(**end ? strtod(*end+1, end) : 0));
+  if (**end) ++*end;
+  return result;
+}
+
+static napi_value convertPoint(napi_env env, char *text, int len) {
+  char *end;
+  return makePoint(env, text, &end);
+}
+
+static napi_value convertBox(napi_env env, char *text, int len) {
+  char *end;
+  napi_value result = makeArray(2);
+  addValue(result, 0, makePoint(env, text, &end));
+  addValue(result, 1, makePoint(env, end+1, &end));
+  return result;
+}
+
+static napi_value convertBound(napi_env env, char *text, int len) {
+  if (len <= 0) return getNull();
+  if (text[0] == '"') len = unQuote(text, len);
+  return convertDate(env, text, len);
+}
+
+static napi_value convertRange(napi_env env, char *text, int len) {
+  napi_value result = makeObject();
+  if (text[0] == 'e') {
+    setProperty(result, "empty", makeBoolean(true));
+    return result;
+  }
+
+  int pos = 1;
+  bool quoted = false;
+  for(; pos < len; ++pos) {
+    char c = text[pos];
+    if (c == '\\') ++pos;
+    else if (c == '"') quoted = ! quoted;
+    else if (c == ',' && ! quoted) break;
+  }
+  if (pos >= len) return convertText(env, text, len);
+
+  char bounds[] = {text[0], text[len-1]};
+  setProperty(result, "lower", convertBound(env, text+1, pos-1));
+  setProperty(result, "upper", convertBound(env, text+pos+1, len-pos-2));
+  setProperty(result, "bounds", makeString(bounds, 2));
+  return result;
+}
+
+typedef struct {
+  transformer t;
+  char delim;
+} TypeConverter;
+
+#define scalarType(t) {t, 0}
+#define arrayType(t) {t, ','}
+
+static TypeConverter baseTypeConverter(Oid type) {
+  TypeConverter text = scalarType(convertText), unknown = {NULL, 0};
   if (type < 143) {
     switch(type) {
-    case 25:
-      return convertText(env, text, len);
-    case 20:
-      if (len > MAX_INT_LEN) break;
-      return convertInt(env, text, len);
-    case 21: case 23: case 26:
-      return convertInt(env, text, len);
-    case 16:
-      return makeBoolean(text[0] == 't');
-    case 17:
-      return convertBytea(env, text, len);
+    case 20: case 21: case 23: case 26: {
+      TypeConverter tc = scalarType(convertInt); return tc;
+    }
+    case 16: {
+      TypeConverter tc = scalarType(convertBoolean); return tc;
+    }
+    case 17: {
+      TypeConverter tc = scalarType(convertBytea); return tc;
+    }
     default:
-      return convertText(env, text, len);
+      return text;
     }
-  } else {
+  }
+
+  TypeConverter tc = unknown;
+  switch(type) {
+  case 700: case 701: tc.t = convertDouble; break;
+  case 3802: return text;
+  case 1082: case 1114: case 1184: tc.t = convertDate; break;
+  case 2950: tc.t = convertUuid; break;
+  case 1700: tc.t = convertNumeric; break;
+  case 790: tc.t = convertMoney; break;
+  case 1186: tc.t = convertInterval; break;
+  case 869: case 650: tc.t = convertInet; break;
+  case 600: tc.t = convertPoint; break;
+  case 603: tc.t = convertBox; break;
+  case 3908: case 3910: case 3912: tc.t = convertRange; break;
+  default: {
+    TypeConverter atc = arrayType(NULL);
     switch(type) {
-    case 700: case 701:
-      return convertDouble(env, text, len);
-    case 3802:
-      return convertText(env, text, len);
-    case 1000:
-      return convertArray(env, convertBoolean, text, len);
-    case 1001:
-      return convertArray(env, convertBytea, text, len);
-    case 1007: case 1016: case 1005: case 1028:
-      return convertArray(env, convertInt, text, len);
-    case 1009: case 1014:
-      return convertArray(env, convertText, text, len);
-    case 1021: case 1022:
-      return convertArray(env, convertDouble, text, len);
-    case 1082: case 1114: case 1184:
-      return convertDate(env, text, len);
-    case 1115: case 1182: case 1185:
-      return convertArray(env, convertDate, text, len);
+    case 1000: atc.t = convertBoolean; break;
+    case 1001: atc.t = convertBytea; break;
+    case 1007: case 1016: case 1005: case 1028: atc.t = convertInt; break;
+    case 1009: case 1014: atc.t = convertText; break;
+    case 1021: case 1022: atc.t = convertDouble; break;
+    case 1115: case 1182: case 1185: atc.t = convertDate; break;
+    case 2951: atc.t = convertUuid; break;
+    case 1231: atc.t = convertNumeric; break;
+    case 791: atc.t = convertMoney; break;
+    case 1187: atc.t = convertInterval; break;
+    case 1041: atc.t = convertInet; break;
+    case 651: atc.t = convertInet; break;
+    case 1017: atc.t = convertPoint; break;
+    case 1020: atc.t = convertBox; atc.delim = ';'; break;
+    case 3909: case 3911: case 3913: atc.t = convertRange; break;
     }
+    if (atc.t != NULL) return atc;
+  }
   }
+  return tc;
+}
 
-  if (len > 1 && text[0] == '{' && text[len-1] == '}')
-    return convertArray(env, convertText, text, len);
+static TypeConverter typeConverter(Oid type, const TypeModes* modes) {
+  TypeConverter tc = baseTypeConverter(type);
+  const int tm = findTypeMode(type);
+  if (tm >= 0 && modes->mode[tm] == PGLIBPQ_MODE_TEXT) tc.t = convertText;
+  return tc;
+}
 
-  return makeString(text, len);
+static napi_value convertCell(napi_env env, TypeConverter* tc, napi_value parser,
+                              char *text, int len) {
+  if (tc->t == NULL) {
+    if (len > 1 && text[0] == '{' && text[len-1] == '}')
+      return _convertArray(env, convertText, parser, ',', text, len).result;
+    return applyParser(env, parser, convertText(env, text, len));
+  }
+  if (tc->delim != 0)
+    return _convertArray(env, tc->t, parser, tc->delim, text, len).result;
+  return applyParser(env, parser, tc->t(env, text, len));
+}
+
+typedef struct {
+  Oid oid;
+  napi_ref ref;
+} TypeParser;
+
+typedef struct {
+  TypeParser* list;
+  int len, cap;
+} TypeParsers;
+
+static TypeParser* findTypeParser(TypeParsers* tps, Oid oid) {
+  for(int i = 0; i < tps->len; ++i) {
+    if (tps->list[i].oid == oid) return &tps->list[i];
+  }
+  return NULL;
+}
+
+static napi_value getTypeParser(napi_env env, TypeParsers* tps, Oid oid) {
+  TypeParser* tp = findTypeParser(tps, oid);
+  return tp == NULL ? NULL : getRef(tp->ref);
+}
+
+static napi_value setTypeParser(napi_env env, TypeParsers* tps, Oid oid, napi_value parser) {
+  napi_value prev = NULL;
+  TypeParser* tp = findTypeParser(tps, oid);
+  if (tp != NULL) {
+    prev = getRef(tp->ref);
+    assertok(napi_delete_reference(env, tp->ref));
+    *tp = tps->list[--tps->len];
+  }
+  if (parser != NULL) {
+    if (tps->len == tps->cap) {
+      tps->cap = tps->cap == 0 ? 16 : tps->cap*2;
+      tps->list = countedRealloc(tps->list, sizeof(TypeParser)*tps->cap);
+    }
+    tp = &tps->list[tps->len++];
+    tp->oid = oid;
+    assertok(napi_create_reference(env, parser, 1, &tp->ref));
+  }
+  return prev;
 }
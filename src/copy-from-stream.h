@@ -1,8 +1,8 @@
 static napi_value init_copyFromStream(napi_env env, napi_callback_info info,
                                Conn* conn, size_t argc, napi_value args[]) {
-  return init_execParams(env, info, conn, argc, args);
+  return init_copyCommand(env, info, conn, argc, args);
 }
-#define async_copyFromStream async_execParams
+#define async_copyFromStream async_copyCommand
 #define done_copyFromStream done_execParams
 defAsync(copyFromStream, 3);
 
@@ -15,7 +15,7 @@ typedef struct {
 
 static napi_value init_putCopyData(napi_env env, napi_callback_info info,
                             Conn* conn, size_t argc, napi_value args[]) {
-  PutData *putData = calloc(1, sizeof(PutData));
+  PutData *putData = arenaCalloc(&conn->arena, sizeof(PutData));
   assertok(napi_create_reference(env, args[0], 1, &putData->ref));
   assertok(napi_get_buffer_info(env,
                                 args[0],
@@ -31,6 +31,8 @@ static void async_putCopyData(Conn* conn) {
   unlockConn();
   if (PQputCopyData(pq, putData->data, putData->length) == -1)
     putData->error = PQerrorMessage(pq);
+  else
+    atomicAdd(&conn->counters.bytesSent, (int64_t)putData->length);
   lockConn();
 }
 
@@ -45,9 +47,9 @@ defAsync(putCopyData, 2);
 
 static napi_value init_putCopyEnd(napi_env env, napi_callback_info info,
                            Conn* conn, size_t argc, napi_value args[]) {
-  PutData *putData =  calloc(1, sizeof(PutData));
+  PutData *putData = arenaCalloc(&conn->arena, sizeof(PutData));
   if (argc > 1 && jsType(args[0]) == napi_string) {
-    putData->data = getString(args[0]);
+    putData->data = arenaGetString(&conn->arena, args[0]);
   }
   conn->request = putData;
   return NULL;
@@ -59,16 +61,17 @@ static void async_putCopyEnd(Conn* conn) {
   unlockConn();
   if (PQputCopyEnd(pq, putData->data) == -1)
     putData->error = PQerrorMessage(pq);
+  else {
+    PGresult* extra;
+    conn->result = PQgetResult(pq);
+    while ((extra = PQgetResult(pq)) != NULL)
+      PQclear(extra);
+  }
   lockConn();
 }
 
 static void done_putCopyEnd(napi_env env, Conn* conn, napi_value cb_args[]) {
   conn->copy_inprogress = 0;
-  PutData* putData = conn->request;
-  if (putData->data != NULL) {
-    free(putData->data);
-    putData->data = NULL;
-  }
   done_putCopyData(env, conn, cb_args);
 }
 
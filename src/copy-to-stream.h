@@ -1,8 +1,8 @@
 static napi_value init_copyToStream(napi_env env, napi_callback_info info,
                                     Conn* conn, size_t argc, napi_value args[]) {
-  return init_execParams(env, info, conn, argc, args);
+  return init_copyCommand(env, info, conn, argc, args);
 }
-#define async_copyToStream async_execParams
+#define async_copyToStream async_copyCommand
 #define done_copyToStream done_execParams
 defAsync(copyToStream, 3);
 
@@ -17,17 +17,26 @@ typedef struct {
   void *data;
   int length;
   int state;
+  uv_cond_t cond;
+  bool replication;
+  int statusMs;
+  int64_t pushed;
+  int64_t flushed;
+  char* error;
 } GetData;
 
+static void async_getReplicationData(void* data);
+
 static void async_getCopyData(void* data) {
   GetData *gd = data;
+  Conn* conn = gd->conn;
   char *buffer = NULL;
   int size = 0, pos = 0, length = 0;
 
   lockConn();
   int maxSize = gd->readSize;
   uv_sem_t* sem = &gd->sem;
-  PGconn* pq = gd->conn->pq;
+  PGconn* pq = conn->pq;
 
   for (;;) {
     unlockConn();
@@ -39,7 +48,7 @@ static void async_getCopyData(void* data) {
 
     unlockConn();
 
-    data = malloc(maxSize);
+    data = countedMalloc(maxSize);
     length = 0;
     if (size > 0) {
       length = maxSize <= size ? maxSize : size;
@@ -50,6 +59,7 @@ static void async_getCopyData(void* data) {
     if (size == 0 && length < maxSize) {
       if (buffer) PQfreemem(buffer);
       while ((size = PQgetCopyData(pq, &buffer, 0)) > 0) {
+        atomicAdd(&gd->conn->counters.bytesReceived, size);
         pos = maxSize - length;
         strncpy(data+length, buffer, pos <= size ? pos : size);
         if (pos <= size) {
@@ -88,7 +98,7 @@ static void async_getCopyData(void* data) {
 }
 
 static void freeCopyData(napi_env env, void* finalize_data, void* finalize_hint) {
-  free(finalize_data);
+  countedFree(finalize_data);
 }
 
 static void copyOutCleanup(napi_env env, Conn* conn) {
@@ -98,38 +108,57 @@ static void copyOutCleanup(napi_env env, Conn* conn) {
     gd->state = 2;
     conn->request = NULL;
     uv_sem_post(&gd->sem);
+    uv_cond_signal(&gd->cond);
     assertok(napi_unref_threadsafe_function(env, gd->threadsafe_func));
     unlockConn();
     uv_thread_join(&gd->thread);
+    atomicAdd(&threadCount, -1);
     lockConn();
     conn->copy_inprogress = 0;
     uv_sem_destroy(&gd->sem);
+    uv_cond_destroy(&gd->cond);
     if (! pushInProgress) {
-      free(gd);
+      countedFree(gd->error);
+      countedFree(gd);
     }
   }
 }
 
 static void pushCopyData(napi_env env, napi_value js_callback, void* context, void* data) {
-  lockConn();
   GetData *gd = context;
+  Conn* conn = gd->conn;
+  lockConn();
 
   if (gd->state == 2) {
-    free(gd);
+    countedFree(gd->error);
+    countedFree(gd);
+    unlockConn();
+    return;
+  }
+  if (env == NULL) {
     unlockConn();
     return;
   }
 
   napi_value push = getRef(gd->ref);
 
-  if (gd->length == 0) {
+  if (gd->error != NULL) {
+    napi_value args[] = {getNull(), makeError(gd->error)};
+    countedFree(gd->error);
+    gd->error = NULL;
+    callFunction(push, push, 2, args);
+  } else if (gd->length == 0) {
     callFunction(push, push, 0, NULL);
   } else {
     napi_value buffer;
-    assertok(napi_create_external_buffer(env, gd->length, gd->data, freeCopyData, NULL, &buffer));
-    napi_value args[] = {buffer};
-
-    bool more = gd->length ? getBool(callFunction(push, push, 1, args)) : false;
+    napi_value pushed = NULL;
+    if (jsok(napi_create_external_buffer(env, gd->length, gd->data, freeCopyData, NULL,
+                                         &buffer))) {
+      napi_value args[] = {buffer};
+      pushed = callFunction(push, push, 1, args);
+    } else
+      countedFree(gd->data);
+    bool more = pushed != NULL && getBool(pushed);
 
     gd->data = NULL;
     gd->length = 0;
@@ -149,7 +178,7 @@ static napi_value getCopyData(napi_env env, napi_callback_info info) {
   lockConn();
   GetData *gd = conn->request;
 
-  getArgs(2);
+  getArgs(3);
 
   int32_t size = getInt32(args[1]);
 
@@ -173,9 +202,14 @@ static napi_value getCopyData(napi_env env, napi_callback_info info) {
     }
 
   } else {
-    gd = conn->request = calloc(1, sizeof(GetData));
+    gd = conn->request = countedCalloc(1, sizeof(GetData));
 
     uv_sem_init(&gd->sem, 0);
+    uv_cond_init(&gd->cond);
+    if (jsType(args[2]) == napi_number) {
+      gd->replication = true;
+      gd->statusMs = getInt32(args[2]);
+    }
 
     assertok(napi_create_reference(env, args[0], 1, &gd->ref));
     gd->conn = conn;
@@ -193,11 +227,16 @@ static napi_value getCopyData(napi_env env, napi_callback_info info) {
               pushCopyData, // napi_threadsafe_function_call_js call_js_cb,
               &gd->threadsafe_func // napi_threadsafe_function* result);
               ));
-    uv_thread_create(&gd->thread, async_getCopyData, gd);
+    atomicAdd(&threadCount, 1);
+    uv_thread_create(&gd->thread, gd->replication ? async_getReplicationData : async_getCopyData,
+                     gd);
   }
 
   gd->readSize = size;
-  uv_sem_post(&gd->sem);
+  if (gd->replication)
+    uv_cond_signal(&gd->cond);
+  else
+    uv_sem_post(&gd->sem);
 
   unlockConn();
   return NULL;
@@ -0,0 +1,79 @@
+/* Standalone addon running the convert.h decoders without a server; see tools/decode-bench.js */
+#include "napi-helper.h"
+#include <uv.h>
+
+#include <time.h>
+#include <libpq-fe.h>
+#include "arena.h"
+#include "convert.h"
+
+/* This addon is only loaded by tools/decode-bench.js on the main thread. */
+static TypeModes typeModes;
+
+static napi_value convert(napi_env env, napi_callback_info info) {
+  getArgs(2);
+  TypeConverter tc = typeConverter(getInt32(args[0]), &typeModes);
+  char* text = getString(args[1]);
+  napi_value result = convertCell(env, &tc, NULL, text, strlen(text));
+  free(text);
+  return result;
+}
+
+static napi_value bench(napi_env env, napi_callback_info info) {
+  getArgs(3);
+  TypeConverter tc = typeConverter(getInt32(args[0]), &typeModes);
+  const uint32_t count = arrayLength(args[1]);
+  const int32_t iterations = getInt32(args[2]);
+
+  char** texts = countedMalloc(sizeof(char*)*count);
+  int* lens = countedMalloc(sizeof(int)*count);
+  int maxLen = 0;
+  for(uint32_t i = 0; i < count; ++i) {
+    texts[i] = getString(getValue(args[1], i));
+    lens[i] = strlen(texts[i]);
+    if (lens[i] > maxLen) maxLen = lens[i];
+  }
+  char* scratch = countedMalloc(maxLen+1);
+
+  uint64_t start = uv_hrtime();
+  for(int32_t n = 0; n < iterations; ++n) {
+    napi_handle_scope scope;
+    assertok(napi_open_handle_scope(env, &scope));
+    for(uint32_t i = 0; i < count; ++i) {
+      memcpy(scratch, texts[i], lens[i]+1);
+      convertCell(env, &tc, NULL, scratch, lens[i]);
+    }
+    assertok(napi_close_handle_scope(env, scope));
+  }
+  uint64_t elapsed = uv_hrtime() - start;
+
+  for(uint32_t i = 0; i < count; ++i) free(texts[i]);
+  countedFree(texts);
+  countedFree(lens);
+  countedFree(scratch);
+  return makeDouble((double)elapsed);
+}
+
+static napi_value setTypeMode(napi_env env, napi_callback_info info) {
+  getArgs(2);
+  const int tm = findTypeMode(getInt32(args[0]));
+  if (tm >= 0) typeModes.mode[tm] = getInt32(args[1]);
+  return NULL;
+}
+
+#define defFunc(func) {#func, 0, func, 0, 0, 0, napi_default, 0}
+
+static napi_value Init(napi_env env, napi_value exports) {
+  initTypeModes(&typeModes);
+  napi_property_descriptor properties[] = {
+    defFunc(convert),
+    defFunc(bench),
+    defFunc(setTypeMode),
+  };
+  assertok(napi_define_properties(env, exports,
+                                  sizeof(properties)/sizeof(napi_property_descriptor),
+                                  properties));
+  return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,238 @@
+#include <math.h>
+#include <inttypes.h>
+
+typedef struct {
+  char* data;
+  size_t length;
+  size_t size;
+  Arena* arena;
+} SqlBuf;
+
+static char* bufReserve(SqlBuf* buf, size_t len) {
+  if (buf->length + len > buf->size) {
+    size_t size = buf->size == 0 ? 256 : buf->size*2;
+    while (size < buf->length + len) size *= 2;
+    buf->data = buf->arena == NULL
+      ? countedRealloc(buf->data, size)
+      : arenaGrow(buf->arena, buf->data, buf->size, size);
+    buf->size = size;
+  }
+  return buf->data + buf->length;
+}
+
+static void bufAdd(SqlBuf* buf, const char* text, size_t len) {
+  memcpy(bufReserve(buf, len), text, len);
+  buf->length += len;
+}
+
+#define bufAddChar(buf, c) {*bufReserve(buf, 1) = c; ++(buf)->length;}
+
+static void bufFree(SqlBuf* buf) {
+  if (buf->arena == NULL) countedFree(buf->data);
+  buf->data = NULL;
+  buf->length = buf->size = 0;
+}
+
+static void encodeString(napi_env env, SqlBuf* buf, napi_value value) {
+  size_t len = getStringLen(value);
+  char* dest = bufReserve(buf, len+1);
+  assertok(napi_get_value_string_utf8(env, value, dest, len+1, &len));
+  buf->length += len;
+}
+
+static void encodeNumber(SqlBuf* buf, double value) {
+  char text[32];
+  int len;
+  if (isnan(value))
+    len = sprintf(text, "NaN");
+  else if (isinf(value))
+    len = sprintf(text, value < 0 ? "-Infinity" : "Infinity");
+  else if (value == 0)
+    len = sprintf(text, "0");
+  else if (value == trunc(value) && fabs(value) <= 9007199254740992.0)
+    len = sprintf(text, "%.0f", value);
+  else {
+    for(int p = 15; ; ++p) {
+      len = sprintf(text, "%.*g", p, value);
+      if (p == 17 || strtod(text, NULL) == value) break;
+    }
+  }
+  bufAdd(buf, text, len);
+}
+
+static bool encodeDate(napi_env env, SqlBuf* buf, napi_value value) {
+  double ms;
+  assertok(napi_get_date_value(env, value, &ms));
+  if (isnan(ms)) {
+    assertok(napi_throw_range_error(env, NULL, "Invalid time value"));
+    return false;
+  }
+  double secs = floor(ms / 1000);
+  time_t time = (time_t)secs;
+  struct tm tm;
+#ifdef _WIN32
+  gmtime_s(&tm, &time);
+#else
+  gmtime_r(&time, &tm);
+#endif
+  int year = tm.tm_year + 1900;
+  char text[64];
+  int len = year > 0
+    ? sprintf(text, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+              year, tm.tm_mon+1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+              (int)(ms - secs*1000))
+    : sprintf(text, "%04d-%d-%dT%d:%d:%d.%03d BC",
+              1-year, tm.tm_mon+1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+              (int)(ms - secs*1000));
+  bufAdd(buf, text, len);
+  return true;
+}
+
+static size_t typedArrayElementSize(napi_typedarray_type type) {
+  switch(type) {
+  case napi_int16_array: case napi_uint16_array:
+    return 2;
+  case napi_int32_array: case napi_uint32_array: case napi_float32_array:
+    return 4;
+  case napi_float64_array: case napi_bigint64_array: case napi_biguint64_array:
+    return 8;
+  default:
+    return 1;
+  }
+}
+
+static const char hexDigits[] = "0123456789abcdef";
+
+static void encodeBytes(SqlBuf* buf, u_char* data, size_t len) {
+  char* dest = bufReserve(buf, len*2+2);
+  *dest++ = '\\'; *dest++ = 'x';
+  for(size_t i = 0; i < len; ++i) {
+    *dest++ = hexDigits[data[i] >> 4];
+    *dest++ = hexDigits[data[i] & 15];
+  }
+  buf->length += len*2+2;
+}
+
+/* Returns 0 for sql NULL, 1 if the value was written and -1 if an exception is pending. */
+static int encodeValue(napi_env env, SqlBuf* buf, napi_value value) {
+  switch(jsType(value)) {
+  case napi_undefined: case napi_null:
+    return 0;
+  case napi_string:
+    encodeString(env, buf, value);
+    return 1;
+  case napi_number: {
+    double d;
+    assertok(napi_get_value_double(env, value, &d));
+    encodeNumber(buf, d);
+    return 1;
+  }
+  case napi_boolean:
+    if (getBool(value))
+      bufAdd(buf, "true", 4);
+    else
+      bufAdd(buf, "false", 5);
+    return 1;
+  case napi_bigint: {
+    int64_t i;
+    bool lossless;
+    assertok(napi_get_value_bigint_int64(env, value, &i, &lossless));
+    if (lossless) {
+      char text[24];
+      bufAdd(buf, text, sprintf(text, "%" PRId64, i));
+      return 1;
+    }
+    break;
+  }
+  case napi_object: {
+    bool is;
+    assertok(napi_is_buffer(env, value, &is));
+    if (is) {
+      void* data;
+      size_t len;
+      assertok(napi_get_buffer_info(env, value, &data, &len));
+      encodeBytes(buf, data, len);
+      return 1;
+    }
+    assertok(napi_is_typedarray(env, value, &is));
+    if (is) {
+      napi_typedarray_type type;
+      size_t len, offset;
+      void* data;
+      napi_value ab;
+      assertok(napi_get_typedarray_info(env, value, &type, &len, &data, &ab, &offset));
+      encodeBytes(buf, data, len*typedArrayElementSize(type));
+      return 1;
+    }
+    assertok(napi_is_date(env, value, &is));
+    if (is) return encodeDate(env, buf, value) ? 1 : -1;
+
+    napi_value json, stringify = getRef(getEnvData()->jsonStringifyRef);
+    if (napi_call_function(env, getGlobal(), stringify, 1, &value, &json) != napi_ok)
+      return -1;
+    if (jsType(json) != napi_string) return 0;
+    encodeString(env, buf, json);
+    return 1;
+  }
+  default:
+    break;
+  }
+
+  napi_value str;
+  if (napi_coerce_to_string(env, value, &str) != napi_ok) return -1;
+  encodeString(env, buf, str);
+  return 1;
+}
+
+static bool needsArrayQuote(char* text, size_t len) {
+  if (len == 0) return true;
+  if (len == 4 && (strncmp(text, "NULL", 4) == 0 || strncmp(text, "null", 4) == 0)) return true;
+  for(size_t i = 0; i < len; ++i) {
+    switch(text[i]) {
+    case '\\': case ',': case '"': case '{': case '}':
+    case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool encodeArray(napi_env env, SqlBuf* buf, napi_value array) {
+  uint32_t len = arrayLength(array);
+  bufAddChar(buf, '{');
+  for(uint32_t i = 0; i < len; ++i) {
+    if (i != 0) bufAddChar(buf, ',');
+    napi_value value = getValue(array, i);
+    if (isArray(value)) {
+      if (! encodeArray(env, buf, value)) return false;
+      continue;
+    }
+    size_t start = buf->length;
+    switch(encodeValue(env, buf, value)) {
+    case -1: return false;
+    case 0: bufAdd(buf, "NULL", 4); break;
+    default: {
+      size_t elen = buf->length - start;
+      if (! needsArrayQuote(buf->data+start, elen)) break;
+      size_t extra = 2;
+      for(size_t j = start; j < buf->length; ++j) {
+        char c = buf->data[j];
+        if (c == '\\' || c == '"') ++extra;
+      }
+      bufReserve(buf, extra);
+      char* src = buf->data + buf->length;
+      char* dest = src + extra;
+      *--dest = '"';
+      while (src > buf->data + start) {
+        char c = *--src;
+        *--dest = c;
+        if (c == '\\' || c == '"') *--dest = '\\';
+      }
+      *--dest = '"';
+      buf->length += extra;
+    }
+    }
+  }
+  bufAddChar(buf, '}');
+  return true;
+}
@@ -0,0 +1,45 @@
+/* State owned by one napi_env, so the addon can be loaded by the main thread and any number of
+   worker_threads at once. Freed when both the env and its last Conn are gone. */
+
+typedef struct Conn Conn;
+
+typedef struct {
+  Conn* head;
+  Conn* tail;
+  uv_mutex_t lock;
+} ConnQueue;
+
+typedef struct {
+  napi_env env;
+  int refs;
+  uv_mutex_t lock;
+  ConnQueue waitingQueue;
+  napi_threadsafe_function threadsafe_func;
+  int threadsafe_func_count;
+  Conn* conns;
+  TypeParsers typeParsers;
+  TypeModes typeModes;
+  napi_ref jsonStringifyRef;
+  uint64_t sliceNs;
+  int sliceRows;
+  int internMaxLen;
+} EnvData;
+
+static EnvData* _getEnvData(napi_env env) {
+  void* data;
+  assertok(napi_get_instance_data(env, &data));
+  return data;
+}
+#define getEnvData() _getEnvData(env)
+
+static void releaseEnvData(EnvData* ed) {
+  if (--ed->refs != 0) return;
+  uv_mutex_destroy(&ed->waitingQueue.lock);
+  uv_mutex_destroy(&ed->lock);
+  countedFree(ed->typeParsers.list);
+  countedFree(ed);
+}
+
+static void finalizeEnvData(napi_env env, void* data, void* hint) {
+  releaseEnvData(data);
+}
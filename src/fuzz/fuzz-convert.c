@@ -0,0 +1,62 @@
+/* libFuzzer target for the convert.h text decoders. The first input byte picks the type,
+   the second the type modes and the rest is the value as sent by the server. */
+#include "../napi-helper.h"
+
+#include <time.h>
+#include <libpq-fe.h>
+#include "../arena.h"
+#include "../convert.h"
+#include "napi-stub.h"
+
+static const Oid fuzzOids[] = {
+  16, 17, 20, 25, 700, 1082, 1114, 1184, 2950, 1700, 790, 1186, 869, 650, 600, 603,
+  3908, 3910, 3912,
+  1000, 1001, 1007, 1009, 1021, 1115, 1182, 1185, 2951, 1231, 791, 1187, 1041, 651, 1017, 1020,
+  3909, 3911, 3913, 3807, 0,
+};
+
+#define FUZZ_OID_COUNT (sizeof(fuzzOids)/sizeof(Oid))
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size < 2) return 0;
+  napi_env env = NULL;
+  TypeModes modes;
+  for(int i = 0; i < TM_COUNT; ++i) {
+    modes.mode[i] = PGLIBPQ_MODE_TEXT;
+    if (data[1] & (1 << (i % 8))) {
+      for(int mode = PGLIBPQ_MODE_NUMBER; mode <= PGLIBPQ_MODE_BUFFER; ++mode)
+        if (typeModeDefaults[i].allowed & (1 << mode)) modes.mode[i] = mode;
+    }
+  }
+  TypeConverter tc = typeConverter(fuzzOids[data[0] % FUZZ_OID_COUNT], &modes);
+
+  /* Server values are NUL terminated and never contain NUL. */
+  size_t len = size - 2;
+  char* text = malloc(len+1);
+  memcpy(text, data+2, len);
+  text[len] = 0;
+  if (strlen(text) == len && len != 0)
+    convertCell(env, &tc, NULL, text, (int)len);
+
+  free(text);
+  stubReset();
+  return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+/* Replay inputs without libFuzzer: fuzz_convert file... */
+int main(int argc, char** argv) {
+  for(int i = 1; i < argc; ++i) {
+    FILE* file = fopen(argv[i], "rb");
+    if (file == NULL) {
+      perror(argv[i]);
+      return 1;
+    }
+    uint8_t data[65536];
+    size_t size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    LLVMFuzzerTestOneInput(data, size);
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,196 @@
+/* Minimal napi implementation so the decoders can run outside node. Values live until
+   stubReset; string and buffer contents are copied so out of bounds reads are caught. */
+
+struct napi_value__ {
+  napi_valuetype type;
+  struct napi_value__* next;
+  size_t length;
+  double number;
+  char data[];
+};
+
+static struct napi_value__* stubValues = NULL;
+static struct napi_value__ stubNull = {.type = napi_null}, stubGlobal = {.type = napi_object};
+
+static napi_value stubAlloc(napi_valuetype type, size_t length) {
+  napi_value value = calloc(1, sizeof(struct napi_value__) + length);
+  value->type = type;
+  value->length = length;
+  value->next = stubValues;
+  stubValues = value;
+  return value;
+}
+
+static void stubReset(void) {
+  while (stubValues != NULL) {
+    napi_value next = stubValues->next;
+    free(stubValues);
+    stubValues = next;
+  }
+}
+
+static napi_status stubNew(napi_valuetype type, double number, napi_value* result) {
+  *result = stubAlloc(type, 0);
+  (*result)->number = number;
+  return napi_ok;
+}
+
+napi_status napi_get_last_error_info(napi_env env, const napi_extended_error_info** result) {
+  static napi_extended_error_info info = {.error_message = "stub error"};
+  *result = &info;
+  return napi_ok;
+}
+
+napi_status napi_create_object(napi_env env, napi_value* result) {
+  return stubNew(napi_object, 0, result);
+}
+
+napi_status napi_create_array(napi_env env, napi_value* result) {
+  return stubNew(napi_object, 0, result);
+}
+
+napi_status napi_create_array_with_length(napi_env env, size_t length, napi_value* result) {
+  return stubNew(napi_object, length, result);
+}
+
+napi_status napi_create_error(napi_env env, napi_value code, napi_value msg, napi_value* result) {
+  return stubNew(napi_object, 0, result);
+}
+
+napi_status napi_create_int64(napi_env env, int64_t value, napi_value* result) {
+  return stubNew(napi_number, (double)value, result);
+}
+
+napi_status napi_create_double(napi_env env, double value, napi_value* result) {
+  return stubNew(napi_number, value, result);
+}
+
+napi_status napi_create_date(napi_env env, double time, napi_value* result) {
+  return stubNew(napi_object, time, result);
+}
+
+napi_status napi_get_boolean(napi_env env, bool value, napi_value* result) {
+  return stubNew(napi_boolean, value, result);
+}
+
+napi_status napi_create_string_utf8(napi_env env, const char* str, size_t length,
+                                    napi_value* result) {
+  if (length == NAPI_AUTO_LENGTH) length = strlen(str);
+  *result = stubAlloc(napi_string, length);
+  memcpy((*result)->data, str, length);
+  return napi_ok;
+}
+
+napi_status napi_create_string_latin1(napi_env env, const char* str, size_t length,
+                                      napi_value* result) {
+  return napi_create_string_utf8(env, str, length, result);
+}
+
+napi_status napi_create_buffer(napi_env env, size_t length, void** data, napi_value* result) {
+  *result = stubAlloc(napi_object, length);
+  *data = (*result)->data;
+  return napi_ok;
+}
+
+napi_status napi_get_value_string_utf8(napi_env env, napi_value value, char* buf,
+                                       size_t bufsize, size_t* result) {
+  size_t length = value->length;
+  if (buf != NULL) {
+    if (length >= bufsize) length = bufsize-1;
+    memcpy(buf, value->data, length);
+    buf[length] = 0;
+  }
+  if (result != NULL) *result = length;
+  return napi_ok;
+}
+
+napi_status napi_get_value_int32(napi_env env, napi_value value, int32_t* result) {
+  *result = (int32_t)value->number;
+  return napi_ok;
+}
+
+napi_status napi_get_value_bool(napi_env env, napi_value value, bool* result) {
+  *result = value->number != 0;
+  return napi_ok;
+}
+
+napi_status napi_typeof(napi_env env, napi_value value, napi_valuetype* result) {
+  *result = value->type;
+  return napi_ok;
+}
+
+napi_status napi_is_array(napi_env env, napi_value value, bool* result) {
+  *result = false;
+  return napi_ok;
+}
+
+napi_status napi_is_error(napi_env env, napi_value value, bool* result) {
+  *result = false;
+  return napi_ok;
+}
+
+napi_status napi_get_array_length(napi_env env, napi_value value, uint32_t* result) {
+  *result = (uint32_t)value->number;
+  return napi_ok;
+}
+
+napi_status napi_set_element(napi_env env, napi_value object, uint32_t index, napi_value value) {
+  if (index >= object->number) object->number = index+1;
+  return napi_ok;
+}
+
+napi_status napi_get_element(napi_env env, napi_value object, uint32_t index, napi_value* result) {
+  *result = &stubNull;
+  return napi_ok;
+}
+
+napi_status napi_set_named_property(napi_env env, napi_value object, const char* name,
+                                    napi_value value) {
+  return napi_ok;
+}
+
+napi_status napi_get_named_property(napi_env env, napi_value object, const char* name,
+                                    napi_value* result) {
+  return stubNew(napi_number, 0, result);
+}
+
+napi_status napi_get_null(napi_env env, napi_value* result) {
+  *result = &stubNull;
+  return napi_ok;
+}
+
+napi_status napi_get_undefined(napi_env env, napi_value* result) {
+  *result = &stubNull;
+  return napi_ok;
+}
+
+napi_status napi_get_global(napi_env env, napi_value* result) {
+  *result = &stubGlobal;
+  return napi_ok;
+}
+
+napi_status napi_call_function(napi_env env, napi_value recv, napi_value func, size_t argc,
+                               const napi_value* argv, napi_value* result) {
+  *result = argc == 0 ? &stubNull : argv[0];
+  return napi_ok;
+}
+
+napi_status napi_get_cb_info(napi_env env, napi_callback_info cbinfo, size_t* argc,
+                             napi_value* argv, napi_value* this_arg, void** data) {
+  return napi_generic_failure;
+}
+
+napi_status napi_create_reference(napi_env env, napi_value value, uint32_t initial_refcount,
+                                  napi_ref* result) {
+  *result = (napi_ref)value;
+  return napi_ok;
+}
+
+napi_status napi_delete_reference(napi_env env, napi_ref ref) {
+  return napi_ok;
+}
+
+napi_status napi_get_reference_value(napi_env env, napi_ref ref, napi_value* result) {
+  *result = (napi_value)ref;
+  return napi_ok;
+}
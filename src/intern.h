@@ -0,0 +1,74 @@
+/* Per-column table reusing the napi_value of repeated short strings within one conversion
+   slice. Columns that do not repeat enough are dropped after INTERN_SAMPLE lookups. */
+
+#define INTERN_SLOTS 256
+#define INTERN_SAMPLE 512
+
+typedef struct {
+  uint32_t hash;
+  int len;
+  const char* text;
+  napi_value value;
+} InternSlot;
+
+typedef struct {
+  InternSlot* slots;
+  int maxLen, used, lookups, hits;
+  bool active;
+} InternTable;
+
+static void internInit(InternTable* it, int maxLen, TypeConverter* tc, napi_value parser) {
+  it->slots = NULL;
+  it->maxLen = maxLen;
+  it->used = it->lookups = it->hits = 0;
+  it->active = maxLen != 0 && parser == NULL && tc->delim == 0 &&
+    (tc->t == NULL || tc->t == convertText);
+}
+
+static void internFree(InternTable* it) {
+  countedFree(it->slots);
+  it->slots = NULL;
+  it->active = false;
+}
+
+static uint32_t internHash(const char* text, int len) {
+  uint32_t hash = 2166136261u;
+  for(int i = 0; i < len; ++i) hash = (hash ^ (u_char)text[i]) * 16777619u;
+  return hash;
+}
+
+static napi_value internText(napi_env env, InternTable* it, char* text, int len) {
+  if (it->slots == NULL)
+    it->slots = countedCalloc(INTERN_SLOTS, sizeof(InternSlot));
+  const uint32_t hash = internHash(text, len);
+  InternSlot* slot;
+  ++it->lookups;
+  for(int i = hash & (INTERN_SLOTS-1); ; i = (i+1) & (INTERN_SLOTS-1)) {
+    slot = &it->slots[i];
+    if (slot->value == NULL) break;
+    if (slot->hash == hash && slot->len == len && memcmp(slot->text, text, len) == 0) {
+      ++it->hits;
+      return slot->value;
+    }
+  }
+
+  napi_value result = convertText(env, text, len);
+  if (it->used < INTERN_SLOTS/2) {
+    slot->hash = hash;
+    slot->len = len;
+    slot->text = text;
+    slot->value = result;
+    ++it->used;
+  }
+  if (it->lookups == INTERN_SAMPLE && it->hits < INTERN_SAMPLE/2)
+    internFree(it);
+  return result;
+}
+
+static napi_value internCell(napi_env env, InternTable* it, TypeConverter* tc, napi_value parser,
+                             char *text, int len) {
+  if (! it->active || len > it->maxLen ||
+      (tc->t == NULL && len > 1 && text[0] == '{' && text[len-1] == '}'))
+    return convertCell(env, tc, parser, text, len);
+  return internText(env, it, text, len);
+}
@@ -0,0 +1,158 @@
+/* Large object calls on the connection thread. Descriptors are only valid inside a transaction;
+   the JS streams start one when the connection is idle. */
+
+typedef struct {
+  Oid oid;
+  int fd;
+  bool write;
+  char* data;
+  size_t length;
+  napi_ref ref;
+  int64_t result;
+  char* error;
+} LoArgs;
+
+static LoArgs* loArgs(napi_env env, Conn* conn, napi_value fdv) {
+  LoArgs* la = conn->request = arenaCalloc(&conn->arena, sizeof(LoArgs));
+  if (fdv != NULL) la->fd = getInt32(fdv);
+  return la;
+}
+
+static void loDone(napi_env env, Conn* conn, napi_value cb_args[]) {
+  LoArgs* la = conn->request;
+  if (la->error != NULL)
+    cb_args[0] = makeError(la->error);
+  else
+    cb_args[1] = makeInt(la->result);
+}
+
+static void freeChunk(napi_env env, void* data, void* hint) {
+  countedFree(data);
+}
+
+static napi_value init_loCreate(napi_env env, napi_callback_info info,
+                         Conn* conn, size_t argc, napi_value args[]) {
+  loArgs(env, conn, NULL);
+  return NULL;
+}
+
+static void async_loCreate(Conn* conn) {
+  LoArgs* la = conn->request;
+  PGconn* pq = conn->pq;
+  unlockConn();
+  const Oid oid = lo_create(pq, InvalidOid);
+  if (oid == InvalidOid)
+    la->error = PQerrorMessage(pq);
+  la->result = oid;
+  lockConn();
+}
+
+#define done_loCreate loDone
+defAsync(loCreate, 1);
+
+static napi_value init_loOpen(napi_env env, napi_callback_info info,
+                       Conn* conn, size_t argc, napi_value args[]) {
+  LoArgs* la = loArgs(env, conn, NULL);
+  la->oid = (Oid)getInt32(args[0]);
+  la->write = getBool(args[1]);
+  return NULL;
+}
+
+static void async_loOpen(Conn* conn) {
+  LoArgs* la = conn->request;
+  PGconn* pq = conn->pq;
+  unlockConn();
+  la->result = lo_open(pq, la->oid, la->write ? INV_READ | INV_WRITE : INV_READ);
+  if (la->result < 0)
+    la->error = PQerrorMessage(pq);
+  lockConn();
+}
+
+#define done_loOpen loDone
+defAsync(loOpen, 3);
+
+static napi_value init_loRead(napi_env env, napi_callback_info info,
+                       Conn* conn, size_t argc, napi_value args[]) {
+  LoArgs* la = loArgs(env, conn, args[0]);
+  la->length = getInt32(args[1]);
+  return NULL;
+}
+
+static void async_loRead(Conn* conn) {
+  LoArgs* la = conn->request;
+  PGconn* pq = conn->pq;
+  unlockConn();
+  la->data = countedMalloc(la->length);
+  la->result = lo_read(pq, la->fd, la->data, la->length);
+  if (la->result < 0)
+    la->error = PQerrorMessage(pq);
+  else
+    atomicAdd(&conn->counters.bytesReceived, la->result);
+  lockConn();
+}
+
+static void done_loRead(napi_env env, Conn* conn, napi_value cb_args[]) {
+  LoArgs* la = conn->request;
+  if (la->error != NULL || la->result == 0) {
+    countedFree(la->data);
+    if (la->error != NULL)
+      cb_args[0] = makeError(la->error);
+    else
+      jsok(napi_create_buffer(env, 0, NULL, &cb_args[1]));
+    return;
+  }
+  if (napi_create_external_buffer(env, la->result, la->data, freeChunk, NULL,
+                                  &cb_args[1]) != napi_ok) {
+    jsok(napi_create_buffer_copy(env, la->result, la->data, NULL, &cb_args[1]));
+    countedFree(la->data);
+  }
+}
+
+defAsync(loRead, 3);
+
+static napi_value init_loWrite(napi_env env, napi_callback_info info,
+                        Conn* conn, size_t argc, napi_value args[]) {
+  LoArgs* la = loArgs(env, conn, args[0]);
+  assertok(napi_create_reference(env, args[1], 1, &la->ref));
+  assertok(napi_get_buffer_info(env, args[1], (void**)&la->data, &la->length));
+  return NULL;
+}
+
+static void async_loWrite(Conn* conn) {
+  LoArgs* la = conn->request;
+  PGconn* pq = conn->pq;
+  unlockConn();
+  la->result = lo_write(pq, la->fd, la->data, la->length);
+  if (la->result < 0)
+    la->error = PQerrorMessage(pq);
+  else
+    atomicAdd(&conn->counters.bytesSent, la->result);
+  lockConn();
+}
+
+static void done_loWrite(napi_env env, Conn* conn, napi_value cb_args[]) {
+  LoArgs* la = conn->request;
+  napi_delete_reference(env, la->ref);
+  loDone(env, conn, cb_args);
+}
+
+defAsync(loWrite, 3);
+
+static napi_value init_loClose(napi_env env, napi_callback_info info,
+                        Conn* conn, size_t argc, napi_value args[]) {
+  loArgs(env, conn, args[0]);
+  return NULL;
+}
+
+static void async_loClose(Conn* conn) {
+  LoArgs* la = conn->request;
+  PGconn* pq = conn->pq;
+  unlockConn();
+  la->result = lo_close(pq, la->fd);
+  if (la->result < 0)
+    la->error = PQerrorMessage(pq);
+  lockConn();
+}
+
+#define done_loClose loDone
+defAsync(loClose, 2);
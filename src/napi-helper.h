@@ -24,8 +24,18 @@ static int _debugok(napi_env env, napi_status status) {
 #define assertok(n) assert((n) == napi_ok)
 #endif
 
+/* For napi calls that can run JS. These fail with napi_pending_exception once a callback has
+   thrown or a worker is terminating; returns false so the caller can stop, and the exception
+   reaches JS when the native callback returns. Any other failure still asserts. */
+static bool _jsok(napi_env env, napi_status status) {
+  if (status == napi_pending_exception) return false;
+  assertok(status);
+  return true;
+}
+#define jsok(status) _jsok(env, status)
+
 static napi_value _getRef(napi_env env, napi_ref ref) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_get_reference_value(env, ref, &result));
   return result;
 }
@@ -41,17 +51,17 @@ static napi_valuetype _jsType(napi_env env, napi_value value) {
 #define jsType(value) _jsType(env, value)
 
 static napi_value _makeObject(napi_env env) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_create_object(env, &result));
   return result;
 }
 #define makeObject() _makeObject(env)
 
 #define setProperty(object, name, value)                        \
-  assertok(napi_set_named_property(env, object, name, value))
+  jsok(napi_set_named_property(env, object, name, value))
 
 static napi_value _makeString(napi_env env, char* value, size_t len) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_create_string_utf8(env, value, len, &result));
   return result;
 }
@@ -77,26 +87,32 @@ static char* _getString(napi_env env, napi_value src) {
 #define getString(value) _getString(env, value)
 
 static napi_value _makeBoolean(napi_env env, bool value) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_get_boolean(env, value, &result));
   return result;
 }
 #define makeBoolean(value) _makeBoolean(env, value)
 
 static napi_value _makeInt(napi_env env, int64_t value) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_create_int64(env, value, &result));
   return result;
 }
 #define makeInt(value) _makeInt(env, value)
 
 static napi_value _makeDouble(napi_env env, double value) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_create_double(env, value, &result));
   return result;
 }
 #define makeDouble(value) _makeDouble(env, value)
 
+static napi_value _makeDate(napi_env env, double value) {
+  napi_value result = NULL;
+  return jsok(napi_create_date(env, value, &result)) ? result : NULL;
+}
+#define makeDate(value) _makeDate(env, value)
+
 #define addInt(object, index, value) addValue(object, index, makeInt(value))
 
 static int32_t _getInt32(napi_env env, napi_value value) {
@@ -114,7 +130,7 @@ static bool _getBool(napi_env env, napi_value value) {
 #define getBool(value) _getBool(env, value)
 
 static napi_value _makeError(napi_env env, char* msg) {
-  napi_value result;
+  napi_value result = NULL;
 
   assertok(napi_create_error(env, NULL, makeAutoString(msg), &result));
   return result;
@@ -130,12 +146,12 @@ static bool _isError(napi_env env, napi_value value) {
 
 
 static napi_value _makeArray(napi_env env, size_t size) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_create_array_with_length(env, size, &result));
   return result;
 }
 
-#define makeArray(size) _makeArray(env, size);
+#define makeArray(size) _makeArray(env, size)
 
 static bool _isArray(napi_env env, napi_value value) {
   bool result;
@@ -152,10 +168,10 @@ static uint32_t _arrayLength(napi_env env, napi_value value) {
 #define arrayLength(value) _arrayLength(env, value)
 
 #define addValue(object, index, value)                  \
-  assertok(napi_set_element(env, object, index, value))
+  jsok(napi_set_element(env, object, index, value))
 
 static napi_value _getValue(napi_env env, napi_value object, uint32_t index) {
-  napi_value result;
+  napi_value result = NULL;
   assertok(napi_get_element(env, object, index, &result));
   return result;
 }
@@ -176,7 +192,7 @@ static napi_value _getValue(napi_env env, napi_value object, uint32_t index) {
 
 
 static napi_value _getGlobal(napi_env env) {
-  napi_value ans;
+  napi_value ans = NULL;
 
   napi_get_global(env, &ans);
   return ans;
@@ -184,7 +200,7 @@ static napi_value _getGlobal(napi_env env) {
 #define getGlobal() _getGlobal(env)
 
 static napi_value _getNull(napi_env env) {
-  napi_value ans;
+  napi_value ans = NULL;
 
   napi_get_null(env, &ans);
   return ans;
@@ -192,11 +208,14 @@ static napi_value _getNull(napi_env env) {
 #define getNull() _getNull(env)
 
 
+/* Returns NULL if func threw or the env is terminating; the exception stays pending. */
 napi_value _callFunction(napi_env env, napi_value recv, napi_value func,
                          size_t argc, const napi_value* argv) {
-  napi_value ans;
+  napi_value ans = NULL;
 
-  assertok(napi_call_function(env, recv, func, argc, argv, &ans));
+  napi_status status = napi_call_function(env, recv, func, argc, argv, &ans);
+  if (status == napi_pending_exception) return NULL;
+  assertok(status);
 
   return ans;
 }
@@ -204,7 +223,7 @@ napi_value _callFunction(napi_env env, napi_value recv, napi_value func,
 #define callFunction(recv, func, argc, argv) _callFunction(env, recv, func, argc, argv)
 
 napi_value _getProp(napi_env env, napi_value obj, char *prop) {
-  napi_value ans;
+  napi_value ans = NULL;
 
   assertok(napi_get_named_property(env, obj, prop, &ans));
 
@@ -0,0 +1,67 @@
+/* Waits on the connection thread for LISTEN notifications, polling so finish() can abort it. */
+
+#define NOTIFY_POLL_MS 100
+#define NOTIFY_MAX 64
+
+typedef struct {
+  int64_t timeoutMs;
+  PGnotify* notes[NOTIFY_MAX];
+  int count;
+  char* error;
+} NotifyArgs;
+
+static napi_value init_waitForNotify(napi_env env, napi_callback_info info,
+                                     Conn* conn, size_t argc, napi_value args[]) {
+  NotifyArgs* na = conn->request = arenaCalloc(&conn->arena, sizeof(NotifyArgs));
+  na->timeoutMs = jsType(args[0]) == napi_number ? getInt32(args[0]) : -1;
+  return NULL;
+}
+
+static void async_waitForNotify(Conn* conn) {
+  NotifyArgs* na = conn->request;
+  PGconn* pq = conn->pq;
+  const uint64_t deadline = na->timeoutMs < 0
+    ? UINT64_MAX : uv_hrtime() + (uint64_t)na->timeoutMs * 1000000;
+  bool abort = false;
+  unlockConn();
+  for (;;) {
+    PGnotify* note;
+    if (PQconsumeInput(pq) == 0) {
+      na->error = PQerrorMessage(pq);
+      break;
+    }
+    while (na->count < NOTIFY_MAX && (note = PQnotifies(pq)) != NULL)
+      na->notes[na->count++] = note;
+    const uint64_t now = uv_hrtime();
+    if (na->count != 0 || abort || now >= deadline) break;
+    const uint64_t left = (deadline - now) / 1000000;
+    if (waitSocket(PQsocket(pq), true, left < NOTIFY_POLL_MS ? (int)left : NOTIFY_POLL_MS) < 0) {
+      na->error = PQerrorMessage(pq);
+      break;
+    }
+    lockConn();
+    abort = conn->state == PGLIBPQ_STATE_ABORT;
+    unlockConn();
+  }
+  lockConn();
+}
+
+static void done_waitForNotify(napi_env env, Conn* conn, napi_value cb_args[]) {
+  NotifyArgs* na = conn->request;
+  napi_value result = makeArray(na->count);
+  for (int i = 0; i < na->count; ++i) {
+    PGnotify* note = na->notes[i];
+    napi_value obj = makeObject();
+    setProperty(obj, "channel", makeAutoString(note->relname));
+    setProperty(obj, "payload", makeAutoString(note->extra));
+    setProperty(obj, "pid", makeInt(note->be_pid));
+    addValue(result, i, obj);
+    PQfreemem(note);
+  }
+  if (na->error != NULL)
+    cb_args[0] = makeError(na->error);
+  else
+    cb_args[1] = result;
+}
+
+defAsync(waitForNotify, 2);
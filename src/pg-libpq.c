@@ -2,8 +2,16 @@
 
 static void Conn_destructor(napi_env env, void* nativeObject, void* finalize_hint) {
   Conn* conn = nativeObject;
+  EnvData* ed = conn->ed;
+  if (conn->prevConn != NULL)
+    conn->prevConn->nextConn = conn->nextConn;
+  else
+    ed->conns = conn->nextConn;
+  if (conn->nextConn != NULL) conn->nextConn->prevConn = conn->prevConn;
   napi_delete_reference(env, conn->wrapper_);
-  free(conn);
+  arenaFree(&conn->arena);
+  countedFree(conn);
+  releaseEnvData(ed);
 }
 
 static napi_value Conn_constructor(napi_env env, napi_callback_info info) {
@@ -20,8 +28,13 @@ static napi_value Conn_constructor(napi_env env, napi_callback_info info) {
   if (valuetype != napi_undefined)
     assertok(napi_get_value_double(env, args[0], &value));
 
-  Conn* conn = calloc(1, sizeof(Conn));
+  Conn* conn = countedCalloc(1, sizeof(Conn));
   conn->state = PGLIBPQ_STATE_READY;
+  EnvData* ed = conn->ed = getEnvData();
+  ++ed->refs;
+  conn->nextConn = ed->conns;
+  if (ed->conns != NULL) ed->conns->prevConn = conn;
+  ed->conns = conn;
 
   assertok(napi_wrap(env,
                      jsthis,
@@ -36,30 +49,102 @@ static napi_value Conn_constructor(napi_env env, napi_callback_info info) {
 static napi_value init_connectDB(napi_env env, napi_callback_info info,
                           Conn* conn, size_t argc, napi_value args[]) {
   assert(conn->pq == NULL);
-  conn->request = getString(args[0]);
+  conn->request = arenaGetString(&conn->arena, args[0]);
   return NULL;
 }
 
+#define CONNECT_POLL_MS 100
+
+/* Wait up to ms for the socket; returns < 0 on error, 0 on timeout. */
+static int waitSocket(int sock, bool forRead, int ms) {
+#ifdef _WIN32
+  fd_set fds;
+  FD_ZERO(&fds);
+  FD_SET((SOCKET)sock, &fds);
+  struct timeval tv = {ms / 1000, (ms % 1000) * 1000};
+  return select(0, forRead ? &fds : NULL, forRead ? NULL : &fds, NULL, &tv);
+#else
+  struct pollfd pfd = {sock, forRead ? POLLIN : POLLOUT, 0};
+  int rc;
+  while ((rc = poll(&pfd, 1, ms)) < 0 && errno == EINTR);
+  return rc;
+#endif
+}
+
+static int connectTimeout(PGconn* pq) {
+  int secs = 0;
+  PQconninfoOption* options = PQconninfo(pq);
+  if (options == NULL) return 0;
+  for(PQconninfoOption* o = options; o->keyword != NULL; ++o) {
+    if (strcmp(o->keyword, "connect_timeout") == 0 && o->val != NULL)
+      secs = atoi(o->val);
+  }
+  PQconninfoFree(options);
+  return secs;
+}
+
+/* Drive PQconnectPoll, checking between waits whether finish was called. client_encoding goes in
+   the startup packet; it follows the expanded conninfo so it takes precedence. */
 static void async_connectDB(Conn* conn) {
-  void* request = conn->request;
+  const char* keywords[] = {"dbname", "client_encoding", NULL};
+  const char* values[] = {conn->request, "UTF8", NULL};
   dm(conn, connectDB);
   unlockConn();
-  PGconn* pq = PQconnectdb(request);
+  PGconn* pq = PQconnectStartParams(keywords, values, 1);
+  bool timedOut = false, aborted = false;
+  int waitError = 0;
+  if (pq != NULL && PQstatus(pq) != CONNECTION_BAD) {
+    const int timeout = connectTimeout(pq);
+    const uint64_t deadline = timeout <= 0 ? UINT64_MAX : uv_hrtime() + timeout * (uint64_t)1e9;
+    PostgresPollingStatusType poll = PGRES_POLLING_WRITING;
+    while (poll != PGRES_POLLING_OK && poll != PGRES_POLLING_FAILED) {
+      if (poll != PGRES_POLLING_ACTIVE) {
+        const int rc = waitSocket(PQsocket(pq), poll == PGRES_POLLING_READING, CONNECT_POLL_MS);
+        if (rc < 0) {
+#ifdef _WIN32
+          waitError = WSAGetLastError();
+#else
+          waitError = errno;
+#endif
+          break;
+        }
+        if (rc == 0) {
+          lockConn();
+          aborted = conn->state != PGLIBPQ_STATE_BUSY;
+          unlockConn();
+          if (aborted) break;
+          if (uv_hrtime() >= deadline) {
+            timedOut = true;
+            break;
+          }
+          continue;
+        }
+      }
+      poll = PQconnectPoll(pq);
+    }
+  }
   lockConn();
-  if (conn->state != PGLIBPQ_STATE_BUSY)
+  if (aborted || conn->state != PGLIBPQ_STATE_BUSY) {
+    PQfinish(pq);
     return;
+  }
   conn->pq = pq;
-  if (PQstatus(pq) == CONNECTION_OK) {
-    PQsetClientEncoding(conn->pq, "utf-8");
-  } else {
+  conn->request = timedOut ? "timeout expired" : NULL;
+  if (waitError != 0) {
+    const char* reason = uv_strerror(uv_translate_sys_error(waitError));
+    conn->request = arenaAlloc(&conn->arena, strlen(reason) + 40);
+    sprintf(conn->request, "could not wait for the server: %s", reason);
+  }
+  if (PQstatus(pq) != CONNECTION_OK) {
     dm(conn, connectDBFailed);
     conn->state = PGLIBPQ_STATE_ERROR;
   }
 }
 
 static void done_connectDB(napi_env env, Conn* conn, napi_value cb_args[]) {
-  if (conn->state == PGLIBPQ_STATE_ERROR)
-    cb_args[0] = makeError(PQerrorMessage(conn->pq));
+  if (conn->state != PGLIBPQ_STATE_ERROR) return;
+  char* msg = conn->request != NULL ? conn->request : PQerrorMessage(conn->pq);
+  cb_args[0] = makeError(*msg != 0 ? msg : "connection failed");
 }
 
 defAsync(connectDB, 2);
@@ -69,54 +154,127 @@ typedef struct {
   char** params;
   uint32_t paramsLen;
   char* name;
+  SqlBuf paramData;
 } ExecArgs;
 
-static void loadExecArgs(napi_env env, Conn* conn, napi_value cmdv, napi_value paramsv, napi_value namev) {
-  uint32_t i;
-  ExecArgs* ea = calloc(1, sizeof(ExecArgs));
-  conn->request = ea;
-  if (cmdv != NULL) ea->cmd = getString(cmdv);
-  if (namev != NULL) ea->name = getString(namev);
-  if (paramsv != NULL && isArray(paramsv)) {
-    uint32_t len = arrayLength(paramsv);
-    char** params = malloc(sizeof(char*)*len);
-    for(i = 0; i < len; ++i) {
-      napi_value v = getValue(paramsv, i);
-      params[i] = jsType(v) == napi_string ?  getString(v) : NULL;
+static bool loadParams(napi_env env, Arena* arena, ExecArgs* ea, napi_value paramsv) {
+  uint32_t i, len = arrayLength(paramsv);
+  size_t* offsets = arenaAlloc(arena, sizeof(size_t)*(len+1));
+  SqlBuf* buf = &ea->paramData;
+  buf->arena = arena;
+  for(i = 0; i < len; ++i) {
+    offsets[i] = buf->length;
+    switch(encodeValue(env, buf, getValue(paramsv, i))) {
+    case -1:
+      return false;
+    case 0:
+      offsets[i] = SIZE_MAX;
+      break;
+    default:
+      bufAddChar(buf, 0);
     }
-    ea->params = params;
-    ea->paramsLen = len;
   }
+  char** params = arenaAlloc(arena, sizeof(char*)*(len+1));
+  for(i = 0; i < len; ++i)
+    params[i] = offsets[i] == SIZE_MAX ? NULL : buf->data + offsets[i];
+  ea->params = params;
+  ea->paramsLen = len;
+  return true;
 }
 
-static void freeExecArgs(napi_env env, Conn* conn) {
-  uint32_t i;
-  ExecArgs* args = conn->request;
-  if (args->cmd != NULL) free(args->cmd);
-  if (args->name != NULL) free(args->name);
-  char** params = args->params;
-  if (params != NULL) {
-    const size_t len = args->paramsLen;
-    for(i = 0; i < len; ++i) {
-      char* v = params[i];
-      if (v != NULL) free(v);
-    }
-    free(params);
-  }
+static ExecArgs* loadExecArgs(napi_env env, Arena* arena,
+                              napi_value cmdv, napi_value paramsv, napi_value namev) {
+  ExecArgs* ea = arenaCalloc(arena, sizeof(ExecArgs));
+  if (cmdv != NULL) ea->cmd = arenaGetString(arena, cmdv);
+  if (namev != NULL) ea->name = arenaGetString(arena, namev);
+  if (paramsv != NULL && isArray(paramsv))
+    loadParams(env, arena, ea, paramsv);
+  return ea;
+}
+
+#define RESULT_RAW 1
+#define RESULT_BINARY 2
+
+static void setResultMode(napi_env env, Job* job, napi_value value) {
+  const int mode = jsType(value) == napi_number ? getInt32(value) : 0;
+  job->raw = (mode & RESULT_RAW) != 0;
+  job->binary = (mode & RESULT_BINARY) != 0;
+}
+
+static napi_value init_execParams(napi_env env, Job* job, size_t argc, napi_value args[]) {
+  job->request = loadExecArgs(env, &job->arena,
+                              argc > 0 ? args[0] : NULL,
+                              argc > 1 ? args[1] : NULL, NULL);
+  setResultMode(env, job, args[2]);
+  return NULL;
+}
+
+static PGresult* exec_execParams(PGconn* pq, Job* job) {
+  ExecArgs* args = job->request;
+  job->stat = statsLookup(args->cmd, NULL);
+  if (args->params == NULL && ! job->binary)
+    return PQexec(pq, args->cmd);
+  return PQexecParams(pq, args->cmd,
+                      args->paramsLen, NULL, (const char* const*)args->params,
+                      NULL, NULL, job->binary);
+}
+
+static void done_execParams(napi_env env, Conn* conn, napi_value cb_args[]) {
 }
 
-static napi_value init_execParams(napi_env env, napi_callback_info info,
-                           Conn* conn, size_t argc, napi_value args[]) {
-  loadExecArgs(env, conn,
-               argc > 0 ? args[0] : NULL,
-               argc > 1 ? args[1] : NULL, NULL);
+defQueued(execParams, 4);
+
+static napi_value init_prepare(napi_env env, Job* job, size_t argc, napi_value args[]) {
+  job->request = loadExecArgs(env, &job->arena,
+                              argc > 1 ? args[1] : NULL,
+                              NULL,
+                              argc > 0 ? args[0] : NULL);
   return NULL;
 }
 
-static void async_execParams(Conn* conn) {
+static PGresult* exec_prepare(PGconn* pq, Job* job) {
+  ExecArgs* args = job->request;
+  job->stat = statsLookup(args->cmd, NULL);
+  return PQprepare(pq, args->name, args->cmd, 0, NULL);
+}
+
+#define done_prepare done_execParams
+
+defQueued(prepare, 3);
+
+static napi_value init_execPrepared(napi_env env, Job* job, size_t argc, napi_value args[]) {
+  job->request = loadExecArgs(env, &job->arena,
+                              NULL,
+                              argc > 1 ? args[1] : NULL,
+                              argc > 0 ? args[0] : NULL);
+  setResultMode(env, job, args[2]);
+  return NULL;
+}
+
+static PGresult* exec_execPrepared(PGconn* pq, Job* job) {
+  ExecArgs* args = job->request;
+  job->stat = statsLookup(NULL, args->name);
+  return PQexecPrepared(pq, args->name,
+                        args->paramsLen, (const char* const*)args->params,
+                        NULL, NULL, job->binary);
+}
+#define done_execPrepared done_execParams
+defQueued(execPrepared, 4);
+
+/* COPY commands are not queued; their result leaves the connection in copy mode. */
+static napi_value init_copyCommand(napi_env env, napi_callback_info info,
+                                   Conn* conn, size_t argc, napi_value args[]) {
+  conn->request = loadExecArgs(env, &conn->arena,
+                               argc > 0 ? args[0] : NULL,
+                               argc > 1 ? args[1] : NULL, NULL);
+  return NULL;
+}
+
+static void async_copyCommand(Conn* conn) {
   ExecArgs* args = conn->request;
   PGconn* pq = conn->pq;
   unlockConn();
+  conn->stat = statsLookup(args->cmd, NULL);
   if (args->params == NULL)
     conn->result = PQexec(pq, args->cmd);
   else
@@ -126,56 +284,185 @@ static void async_execParams(Conn* conn) {
   lockConn();
 }
 
-static void done_execParams(napi_env env, Conn* conn, napi_value cb_args[]) {
-  freeExecArgs(env, conn);
-}
-
-defAsync(execParams, 3);
+/* Queries sent before asking the server to flush their results, so neither side can block
+   writing while the other is not reading. */
+#define BATCH_PIPELINE_DEPTH 256
 
-static napi_value init_prepare(napi_env env, napi_callback_info info,
-                        Conn* conn, size_t argc, napi_value args[]) {
-  loadExecArgs(env, conn,
-               argc > 1 ? args[1] : NULL,
-               NULL,
-               argc > 0 ? args[0] : NULL);
+typedef struct {
+  char* name;
+  uint32_t count;
+  ExecArgs* sets;
+  PGresult** results;
+  int64_t failed;
+  int64_t resultSize;
+} BatchArgs;
+
+static napi_value init_execPreparedBatch(napi_env env, napi_callback_info info,
+                                  Conn* conn, size_t argc, napi_value args[]) {
+  Arena* arena = &conn->arena;
+  BatchArgs* ba = conn->request = arenaCalloc(arena, sizeof(BatchArgs));
+  ba->name = arenaGetString(arena, args[0]);
+  ba->failed = -1;
+  ba->count = arrayLength(args[1]);
+  ba->sets = arenaCalloc(arena, sizeof(ExecArgs)*ba->count);
+  ba->results = arenaCalloc(arena, sizeof(PGresult*)*ba->count);
+  for(uint32_t i = 0; i < ba->count; ++i) {
+    napi_value paramsv = getValue(args[1], i);
+    if (isArray(paramsv) && ! loadParams(env, arena, &ba->sets[i], paramsv))
+      break;
+  }
   return NULL;
 }
 
-static void async_prepare(Conn* conn) {
-  ExecArgs* args = conn->request;
-  PGconn* pq = conn->pq;
-  unlockConn();
-  conn->result = PQprepare(pq, args->name, args->cmd, 0, NULL);
-  lockConn();
+static bool isFailed(PGresult* result) {
+  switch(PQresultStatus(result)) {
+  case PGRES_BAD_RESPONSE: case PGRES_FATAL_ERROR: return true;
+  default: return false;
+  }
 }
 
-#define done_prepare done_execParams
-
-defAsync(prepare, 3);
-
-static napi_value init_execPrepared(napi_env env, napi_callback_info info,
-                             Conn* conn, size_t argc, napi_value args[]) {
-  loadExecArgs(env, conn,
-               NULL,
-               argc > 1 ? args[1] : NULL,
-               argc > 0 ? args[0] : NULL);
-  return NULL;
+#if PG_VERSION_NUM >= 140000
+/* One pipeline ending in a single sync, so the sets run in one implicit transaction unless the
+   connection is already in one. Sending stops at the first chunk with a failure. */
+static bool runBatch(PGconn* pq, BatchArgs* ba, PGresult** error) {
+  uint32_t sent = 0, received = 0;
+  bool ok = PQenterPipelineMode(pq), synced = false;
+  while (ok && ba->failed < 0 && sent < ba->count) {
+    const uint32_t end = ba->count - sent > BATCH_PIPELINE_DEPTH
+      ? sent + BATCH_PIPELINE_DEPTH : ba->count;
+    for(; ok && sent < end; ++sent) {
+      ExecArgs* set = &ba->sets[sent];
+      ok = PQsendQueryPrepared(pq, ba->name, set->paramsLen, (const char* const*)set->params,
+                               NULL, NULL, 0);
+    }
+    if (! ok) break;
+    if (sent == ba->count)
+      ok = synced = PQpipelineSync(pq);
+    else
+      ok = PQsendFlushRequest(pq) && PQflush(pq) == 0;
+    for(; ok && received < sent; ++received) {
+      PGresult* result = ba->results[received] = PQgetResult(pq);
+      if (result == NULL) {
+        ok = false;
+        break;
+      }
+      for(PGresult* extra; (extra = PQgetResult(pq)) != NULL; ) PQclear(extra);
+      if (ba->failed < 0 && isFailed(result)) ba->failed = received;
+    }
+  }
+  if (ok && ! synced) ok = PQpipelineSync(pq);
+  for(int nulls = 0; ok; ) {
+    PGresult* result = PQgetResult(pq);
+    if (result == NULL) {
+      ok = ++nulls < 2;
+      continue;
+    }
+    nulls = 0;
+    const ExecStatusType status = PQresultStatus(result);
+    if (*error == NULL && isFailed(result))
+      *error = result;
+    else
+      PQclear(result);
+    if (status == PGRES_PIPELINE_SYNC) break;
+  }
+  PQexitPipelineMode(pq);
+  return ok;
+}
+#else
+static bool runBatch(PGconn* pq, BatchArgs* ba, PGresult** error) {
+  const bool wrap = PQtransactionStatus(pq) == PQTRANS_IDLE;
+  if (wrap) PQclear(PQexec(pq, "BEGIN"));
+  for(uint32_t i = 0; i < ba->count; ++i) {
+    ExecArgs* set = &ba->sets[i];
+    PGresult* result = ba->results[i] = PQexecPrepared(
+      pq, ba->name, set->paramsLen, (const char* const*)set->params, NULL, NULL, 0);
+    if (result == NULL) return false;
+    if (isFailed(result)) {
+      ba->failed = i;
+      break;
+    }
+  }
+  if (wrap) {
+    PGresult* result = PQexec(pq, ba->failed < 0 ? "COMMIT" : "ROLLBACK");
+    if (ba->failed < 0 && isFailed(result))
+      *error = result;
+    else
+      PQclear(result);
+  }
+  return true;
 }
+#endif
 
-static void async_execPrepared(Conn* conn) {
-  ExecArgs* args = conn->request;
+static void async_execPreparedBatch(Conn* conn) {
+  BatchArgs* ba = conn->request;
   PGconn* pq = conn->pq;
   unlockConn();
-  conn->result = PQexecPrepared(pq, args->name,
-                                args->paramsLen, (const char* const*)args->params,
-                                NULL, NULL, 0);
+  StatEntry* stat = statsLookup(NULL, ba->name);
+  const uint64_t start = uv_hrtime();
+  PGresult* error = NULL;
+  const bool ok = runBatch(pq, ba, &error);
+  const uint64_t ns = ba->count == 0 ? 0 : (uv_hrtime() - start) / ba->count;
   lockConn();
+  for(uint32_t i = 0; i < ba->count && ba->results[i] != NULL; ++i)
+    statsRecordExec(stat, &conn->counters, ba->results[i], ns);
+
+  if (ba->failed >= 0) {
+    error = ba->results[ba->failed];
+    ba->results[ba->failed] = NULL;
+  } else if (error == NULL && ! ok)
+    error = PQmakeEmptyPGresult(pq, PGRES_FATAL_ERROR);
+  for(uint32_t i = 0; i < ba->count; ++i) {
+    if (error != NULL) {
+      PQclear(ba->results[i]);
+      ba->results[i] = NULL;
+    } else
+      ba->resultSize += resultMemorySize(ba->results[i]);
+  }
+  atomicAdd(&resultBytes, ba->resultSize);
+  atomicAdd(&resultBytesTotal, ba->resultSize);
+  conn->result = error;
 }
-#define done_execPrepared done_execParams
-defAsync(execPrepared, 3);
+
+static void done_execPreparedBatch(napi_env env, Conn* conn, napi_value cb_args[]) {
+  BatchArgs* ba = conn->request;
+  if (isError(cb_args[0])) {
+    if (conn->state != PGLIBPQ_STATE_ABORT && conn->result != NULL)
+      cb_args[0] = makeError(PQresultErrorMessage(conn->result));
+    if (ba->failed >= 0)
+      setProperty(cb_args[0], "batchIndex", makeInt(ba->failed));
+  } else {
+    napi_value results = makeArray(ba->count);
+    bool converted = true;
+    for(uint32_t i = 0; converted && i < ba->count; ++i) {
+      PGresult* result = ba->results[i];
+      napi_value value;
+      if (PQresultStatus(result) == PGRES_TUPLES_OK) {
+        conn->result = result;
+        while ((value = convertRows(env, conn, UINT64_MAX)) == NULL);
+        conn->result = NULL;
+        if (isError(value)) {
+          cb_args[0] = value;
+          converted = false;
+        }
+      } else {
+        const char* tuples = PQcmdTuples(result);
+        value = *tuples == 0 ? getNull() : makeInt(atoll(tuples));
+      }
+      addValue(results, i, value);
+    }
+    if (converted) cb_args[1] = results;
+  }
+  for(uint32_t i = 0; i < ba->count; ++i) PQclear(ba->results[i]);
+  atomicAdd(&resultBytes, -ba->resultSize);
+}
+
+defAsync(execPreparedBatch, 3);
 
 #include "copy-from-stream.h"
 #include "copy-to-stream.h"
+#include "large-object.h"
+#include "replication.h"
+#include "notify.h"
 
 static napi_value escapeLiteral(napi_env env, napi_callback_info info) {
   getConn();
@@ -200,9 +487,99 @@ static napi_value resultErrorField(napi_env env, napi_callback_info info) {
     return getNull();
 }
 
+static napi_value setTypeMode(napi_env env, napi_callback_info info) {
+  getArgs(2);
+  const int tm = findTypeMode(getInt32(args[0]));
+  int32_t mode = getInt32(args[1]);
+  if (tm < 0 || mode < 0 || mode > PGLIBPQ_MODE_BUFFER ||
+      ! (typeModeDefaults[tm].allowed & (1 << mode))) {
+    assertok(napi_throw_range_error(env, NULL, "Unsupported type mode"));
+    return NULL;
+  }
+  TypeModes* modes = &getEnvData()->typeModes;
+  napi_value result = makeInt(modes->mode[tm]);
+  modes->mode[tm] = mode;
+  return result;
+}
+
+static napi_value registerType(napi_env env, napi_callback_info info) {
+  getArgs(2);
+  napi_value parser = NULL;
+  switch(jsType(args[1])) {
+  case napi_undefined: case napi_null: break;
+  case napi_function: parser = args[1]; break;
+  default:
+    assertok(napi_throw_type_error(env, NULL, "parseFunction must be a function"));
+    return NULL;
+  }
+  return setTypeParser(env, &getEnvData()->typeParsers, getInt32(args[0]), parser);
+}
+
+static napi_value toSql(napi_env env, napi_callback_info info) {
+  getArgs(1);
+  SqlBuf buf = {NULL, 0, 0, NULL};
+  napi_value result = NULL;
+  switch(encodeValue(env, &buf, args[0])) {
+  case 0: result = getNull(); break;
+  case 1: result = makeString(buf.data, buf.length); break;
+  }
+  bufFree(&buf);
+  return result;
+}
+
+static napi_value sqlArray(napi_env env, napi_callback_info info) {
+  getArgs(1);
+  SqlBuf buf = {NULL, 0, 0, NULL};
+  napi_value result = NULL;
+  if (encodeArray(env, &buf, args[0]))
+    result = makeString(buf.data, buf.length);
+  bufFree(&buf);
+  return result;
+}
+
+static napi_value setConvertBudget(napi_env env, napi_callback_info info) {
+  getArgs(2);
+  int32_t rows = getInt32(args[0]);
+  double micros;
+  assertok(napi_get_value_double(env, args[1], &micros));
+  if (rows < 0 || micros < 0) {
+    assertok(napi_throw_range_error(env, NULL, "budget must not be negative"));
+    return NULL;
+  }
+  EnvData* ed = getEnvData();
+  ed->sliceRows = rows;
+  ed->sliceNs = (uint64_t)(micros * 1000);
+  return NULL;
+}
+
+static napi_value setInternLength(napi_env env, napi_callback_info info) {
+  getArgs(1);
+  int32_t len = getInt32(args[0]);
+  if (len < 0) {
+    assertok(napi_throw_range_error(env, NULL, "length must not be negative"));
+    return NULL;
+  }
+  getEnvData()->internMaxLen = len;
+  return NULL;
+}
+
+static napi_value allocStats(napi_env env, napi_callback_info info) {
+  napi_value result = makeObject();
+  setProperty(result, "allocs", makeInt(atomicGet(&allocCount)));
+  setProperty(result, "frees", makeInt(atomicGet(&freeCount)));
+  setProperty(result, "allocBytes", makeInt(atomicGet(&allocBytes)));
+  setProperty(result, "arenaBytes", makeInt(atomicGet(&arenaBytes)));
+  setProperty(result, "resultBytes", makeInt(atomicGet(&resultBytes)));
+  setProperty(result, "resultBytesTotal", makeInt(atomicGet(&resultBytesTotal)));
+  setProperty(result, "threads", makeInt(atomicGet(&threadCount)));
+  setProperty(result, "connSize", makeInt(sizeof(Conn)));
+  return result;
+}
+
 static napi_value finish(napi_env env, napi_callback_info info) {
-  uv_mutex_lock(&waitingQueue.lock);
   getConn();
+  ConnQueue* waitingQueue = &conn->ed->waitingQueue;
+  uv_mutex_lock(&waitingQueue->lock);
   lockConn();
   dm(conn, finish);
   if (conn->copy_inprogress == 2) {
@@ -219,11 +596,45 @@ static napi_value finish(napi_env env, napi_callback_info info) {
     unlockConn();
     cleanup(env, conn);
   }
-  uv_mutex_unlock(&waitingQueue.lock);
+  uv_mutex_unlock(&waitingQueue->lock);
+
+  return NULL;
+}
 
+static napi_value setTrace(napi_env env, napi_callback_info info) {
+  getConn();
+  getArgs(1);
+  conn->trace = getBool(args[0]);
   return NULL;
 }
 
+static napi_value lastTimings(napi_env env, napi_callback_info info) {
+  getConn();
+  uint64_t* t = conn->timings;
+  napi_value result = makeArray(6);
+  addValue(result, 0, makeDouble((double)(t[TIMING_EXEC_START] - t[TIMING_SUBMIT])));
+  addValue(result, 1, makeDouble((double)(t[TIMING_EXEC_END] - t[TIMING_EXEC_START])));
+  addValue(result, 2, makeDouble((double)(t[TIMING_COMPLETE] - t[TIMING_EXEC_END])));
+  addValue(result, 3, makeDouble((double)conn->convertNs));
+  addInt(result, 4, conn->resultRows);
+  addInt(result, 5, conn->resultBytes);
+  return result;
+}
+
+static napi_value stats(napi_env env, napi_callback_info info) {
+  getConn();
+  return countersSnapshot(&conn->counters);
+}
+
+static napi_value globalStats(napi_env env, napi_callback_info info) {
+  return statsSnapshot();
+}
+
+static napi_value transactionStatus(napi_env env, napi_callback_info info) {
+  getConn();
+  return makeInt(conn->pq == NULL ? PQTRANS_UNKNOWN : PQtransactionStatus(conn->pq));
+}
+
 static napi_value isReady(napi_env env, napi_callback_info info) {
   getConn();
   return makeBoolean(conn->state == PGLIBPQ_STATE_READY &&
@@ -233,6 +644,7 @@ static napi_value isReady(napi_env env, napi_callback_info info) {
 
 #define defFunc(func) {#func, 0, func, 0, 0, 0, napi_default, 0}
 #define defValue(name, value) {#name, 0, 0, 0, 0, value, napi_default, 0}
+#define defStatic(func) {#func, 0, func, 0, 0, 0, napi_static, 0}
 
 /* static void _addStatic(napi_env env, napi_value object, char* name, napi_callback func) { */
 /*   napi_value result; */
@@ -241,22 +653,66 @@ static napi_value isReady(napi_env env, napi_callback_info info) {
 /* } */
 /* #define addStatic(object, name) _addStatic(env, object, # name, name); */
 
+/* Close the connections of a terminating env so their threads are joined before it goes. */
+static void closeEnvConns(void* data) {
+  EnvData* ed = data;
+  napi_env env = ed->env;
+  for(Conn* conn = ed->conns; conn != NULL; conn = conn->nextConn) {
+    lockConn();
+    if (conn->copy_inprogress == 2) copyOutCleanup(env, conn);
+    if (conn->state == PGLIBPQ_STATE_BUSY || conn->copy_inprogress == 1) cancel(conn);
+    unlockConn();
+    cleanup(env, conn);
+  }
+}
+
 static napi_value Init(napi_env env, napi_value exports) {
+  EnvData* ed = countedCalloc(1, sizeof(EnvData));
+  ed->env = env;
+  ed->refs = 1;
+  ed->sliceNs = SLICE_NS_DEFAULT;
+  ed->internMaxLen = INTERN_MAX_LEN_DEFAULT;
+  initTypeModes(&ed->typeModes);
+  uv_mutex_init(&ed->lock);
+  initQueue(&ed->waitingQueue);
+  assertok(napi_set_instance_data(env, ed, finalizeEnvData, NULL));
+  assertok(napi_add_env_cleanup_hook(env, closeEnvConns, ed));
+
   napi_value PG;
   napi_property_descriptor properties[] = {
     defFunc(connectDB),
     defFunc(finish),
     defFunc(isReady),
+    defFunc(transactionStatus),
+    defFunc(setTrace),
+    defFunc(lastTimings),
+    defFunc(stats),
     defFunc(execParams),
     defFunc(prepare),
     defFunc(execPrepared),
+    defFunc(execPreparedBatch),
+    defFunc(loCreate),
+    defFunc(loOpen),
+    defFunc(loRead),
+    defFunc(loWrite),
+    defFunc(loClose),
     defFunc(copyFromStream),
     defFunc(putCopyData),
     defFunc(putCopyEnd),
     defFunc(copyToStream),
     defFunc(getCopyData),
+    defFunc(acknowledgeLsn),
+    defFunc(waitForNotify),
     defFunc(resultErrorField),
     defFunc(escapeLiteral),
+    defStatic(setTypeMode),
+    defStatic(registerType),
+    defStatic(toSql),
+    defStatic(sqlArray),
+    defStatic(allocStats),
+    defStatic(globalStats),
+    defStatic(setConvertBudget),
+    defStatic(setInternLength),
   };
   assertok(napi_define_class(env,
                              "PGLibPQ",
@@ -267,8 +723,13 @@ static napi_value Init(napi_env env, napi_value exports) {
                              properties,
                              &PG));
 
-  uv_mutex_init(&gLock);
-  initQueue(&waitingQueue);
+  napi_value parseJSON = getProp(getProp(getGlobal(), "JSON"), "parse");
+  setTypeParser(env, &ed->typeParsers, 114, parseJSON);
+  setTypeParser(env, &ed->typeParsers, 199, parseJSON);
+  setTypeParser(env, &ed->typeParsers, 3802, parseJSON);
+  setTypeParser(env, &ed->typeParsers, 3807, parseJSON);
+  assertok(napi_create_reference(env, getProp(getProp(getGlobal(), "JSON"), "stringify"), 1,
+                                 &ed->jsonStringifyRef));
 
   return PG;
 }
@@ -2,11 +2,24 @@
 #include <uv.h>
 
 #include <time.h>
+#ifndef _WIN32
+#include <poll.h>
+#include <errno.h>
+#endif
 #include <libpq-fe.h>
+#include <libpq/libpq-fs.h>
 #include <pg_config.h>
+#include "arena.h"
 #include "convert.h"
-
-typedef struct Conn Conn;
+#include "intern.h"
+#include "env-data.h"
+#include "encode.h"
+#include "stats.h"
+
+enum {
+  TIMING_SUBMIT, TIMING_EXEC_START, TIMING_EXEC_END, TIMING_COMPLETE, TIMING_CONVERT_END,
+  TIMING_COUNT
+};
 
 typedef napi_value (*conn_async_init)(napi_env env, napi_callback_info info,
                                       Conn* conn, size_t argc, napi_value args[]);
@@ -15,10 +28,44 @@ typedef void (*conn_async_execute)(Conn* conn);
 
 typedef void (*conn_async_complete)(napi_env env,
                                     Conn* conn, napi_value cb_args[]);
+
+typedef struct Job Job;
+
+typedef napi_value (*conn_job_init)(napi_env env, Job* job, size_t argc, napi_value args[]);
+
+typedef PGresult* (*conn_job_execute)(PGconn* pq, Job* job);
+
+/* A query marshalled with its own arena so the connection thread can run it while the result
+   before it is still being converted; async_complete moves it into the Conn. */
+struct Job {
+  Job* next;
+  conn_job_execute execute;
+  conn_async_complete complete;
+  void* request;
+  Arena arena;
+  napi_ref callback_ref;
+  bool raw;
+  bool binary;
+  bool executed;
+  PGresult* result;
+  char* connError;
+  int64_t resultSize;
+  StatEntry* stat;
+  uint64_t timings[TIMING_COUNT];
+};
+
+/* Queued jobs per connection, counting the one being converted. */
+#define JOB_QUEUE_DEPTH 4
+
 struct Conn {
+  EnvData* ed;
+  Conn* prevConn;
+  Conn* nextConn;
+  bool hasThread;
   PGconn* pq;
   int state;
   PGresult* result;
+  char* connError;
   char copy_inprogress;
   void* request;
   uv_thread_t thread;
@@ -27,31 +74,50 @@ struct Conn {
   napi_ref callback_ref;
   conn_async_execute execute;
   conn_async_complete complete;
+  Arena arena;
+  Conn* nextWaiting;
+  bool trace;
+  bool raw;
+  bool binary;
+  struct ResultHold* hold;
+  uint64_t timings[TIMING_COUNT];
+  int64_t resultRows;
+  int64_t resultBytes;
+  StatEntry* stat;
+  ConnCounters counters;
+  int64_t resultSize;
+  napi_ref rowsRef;
+  int convertRow;
+  uint64_t convertNs;
+  Job* jobs;
+  Job* jobsTail;
+  Job* nextJob;
+  Job* active;
+  Job* spareJobs;
+  int jobCount;
 };
 
-uv_mutex_t gLock;
+#define traceTime(conn, stage) if (conn->trace) conn->timings[TIMING_ ## stage] = uv_hrtime()
 
+static int64_t resultBytes, resultBytesTotal, threadCount;
 
-#define lockConn() {uv_mutex_lock(&gLock);}
-#define unlockConn() {uv_mutex_unlock(&gLock);}
+/* Conversion work done per event loop turn; 0 is unlimited. */
+#define SLICE_NS_DEFAULT 4000000
+#define INTERN_MAX_LEN_DEFAULT 32
 
-typedef struct NextConn NextConn;
+#define SLICE_CHECK_CELLS 1024
 
-struct NextConn {
-  Conn* conn;
-  NextConn* next;
-};
+#if PG_VERSION_NUM >= 120000
+#define resultMemorySize(result) (int64_t)PQresultMemorySize(result)
+#else
+#define resultMemorySize(result) 0
+#endif
 
-typedef struct {
-  NextConn* head;
-  NextConn* tail;
-  uv_mutex_t lock;
-} ConnQueue;
+#include "binary.h"
 
-static ConnQueue waitingQueue;
 
-static napi_threadsafe_function threadsafe_func;
-static int threadsafe_func_count;
+#define lockConn() {uv_mutex_lock(&conn->ed->lock);}
+#define unlockConn() {uv_mutex_unlock(&conn->ed->lock);}
 
 static void initQueue(ConnQueue* queue) {
   queue->head = queue->tail = NULL;
@@ -59,27 +125,22 @@ static void initQueue(ConnQueue* queue) {
 }
 
 static void queueAddConn(ConnQueue* queue, Conn* conn) {
-  NextConn* node = malloc(sizeof(NextConn));
-  node->conn = conn;
-  node->next = NULL;
+  conn->nextWaiting = NULL;
   if (queue->head == NULL) {
-    queue->head = queue->tail = node;
+    queue->head = queue->tail = conn;
   } else {
-    queue->tail->next = node;
-    queue->tail = node;
+    queue->tail->nextWaiting = conn;
+    queue->tail = conn;
   }
 }
 
 static Conn* queueRmHead(ConnQueue* queue) {
-  Conn* conn = NULL;
   uv_mutex_lock(&queue->lock);
-  NextConn* node = queue->head;
-  if (node) {
-    queue->head = node->next;
+  Conn* conn = queue->head;
+  if (conn) {
+    queue->head = conn->nextWaiting;
     if (! queue->head) queue->tail = NULL;
-
-    conn = node->conn;
-    free(node);
+    conn->nextWaiting = NULL;
   }
   uv_mutex_unlock(&queue->lock);
   return conn;
@@ -88,13 +149,14 @@ static Conn* queueRmHead(ConnQueue* queue) {
 static void thread_finalize_cb(napi_env env,
                               void* finalize_data,
                               void* finalize_hint) {
-  threadsafe_func = NULL;
+  EnvData* ed = finalize_data;
+  ed->threadsafe_func = NULL;
 }
 
 static void runCallbacks(napi_env env, napi_value js_callback, void* context, void* data);
 
-static void ref_threadsafe_func(napi_env env) {
-  if (threadsafe_func == NULL) {
+static void ref_threadsafe_func(napi_env env, EnvData* ed) {
+  if (ed->threadsafe_func == NULL) {
 
     assertok(napi_create_threadsafe_function
              (env, // napi_env env,
@@ -103,21 +165,21 @@ static void ref_threadsafe_func(napi_env env) {
               makeAutoString("pgCallback"), // napi_value async_resource_name,
               0, // size_t max_queue_size,
               1, // size_t initial_thread_count,
-              NULL, // void* thread_finalize_data,
+              ed, // void* thread_finalize_data,
               thread_finalize_cb, // napi_finalize thread_finalize_cb,
-              NULL, // void* context,
+              ed, // void* context,
               runCallbacks, // napi_threadsafe_function_call_js call_js_cb,
-              &threadsafe_func // napi_threadsafe_function* result);
+              &ed->threadsafe_func // napi_threadsafe_function* result);
               ));
-    threadsafe_func_count = 1;
-  } else if (++threadsafe_func_count == 1) {
-    assertok(napi_ref_threadsafe_function(env, threadsafe_func));
+    ed->threadsafe_func_count = 1;
+  } else if (++ed->threadsafe_func_count == 1) {
+    assertok(napi_ref_threadsafe_function(env, ed->threadsafe_func));
   }
 }
 
-static void unref_threadsafe_func(napi_env env) {
-  if (--threadsafe_func_count == 0)
-    assertok(napi_unref_threadsafe_function(env, threadsafe_func));
+static void unref_threadsafe_func(napi_env env, EnvData* ed) {
+  if (--ed->threadsafe_func_count == 0 && ed->threadsafe_func != NULL)
+    assertok(napi_unref_threadsafe_function(env, ed->threadsafe_func));
 }
 
 #define PGLIBPQ_STATE_ABORT -2
@@ -140,7 +202,14 @@ static void throwStateError(napi_env env, const char* expect) {
 
 static void clearResult(Conn* conn) {
   if (conn->result != NULL) {
-    PQclear(conn->result);
+    if (conn->hold != NULL) {
+      releaseHold(conn->hold);
+      conn->hold = NULL;
+    } else {
+      atomicAdd(&resultBytes, -conn->resultSize);
+      PQclear(conn->result);
+    }
+    conn->resultSize = 0;
     conn->result = NULL;
   }
 }
@@ -162,27 +231,59 @@ static void cancel(Conn* conn) {
   }
 }
 
+static void freeJob(napi_env env, Job* job) {
+  if (job->result != NULL) {
+    atomicAdd(&resultBytes, -job->resultSize);
+    PQclear(job->result);
+  }
+  if (job->callback_ref != NULL)
+    assertok(napi_delete_reference(env, job->callback_ref));
+  arenaFree(&job->arena);
+  countedFree(job);
+}
+
+static void freeJobs(napi_env env, Conn* conn) {
+  Job* lists[] = {conn->active, conn->jobs, conn->spareJobs};
+  for(int i = 0; i < 3; ++i)
+    for(Job* job = lists[i]; job != NULL; ) {
+      Job* next = i == 0 ? NULL : job->next;
+      freeJob(env, job);
+      job = next;
+    }
+  conn->active = conn->jobs = conn->jobsTail = conn->nextJob = conn->spareJobs = NULL;
+  conn->jobCount = 0;
+}
+
 static void cleanup(napi_env env, Conn* conn) {
   lockConn();
-  if (conn->state == PGLIBPQ_STATE_CLOSED) return;
+  if (conn->state == PGLIBPQ_STATE_CLOSED) {
+    unlockConn();
+    return;
+  }
 
   conn->state = PGLIBPQ_STATE_CLOSED;
 
   freeCallbackRef(env, conn);
   clearResult(conn);
-  if (conn->pq != NULL) {
+  if (conn->hasThread) {
     dm(conn, post);
     uv_sem_post(&conn->sem);
     unlockConn();
     uv_thread_join(&conn->thread);
-    unref_threadsafe_func(env);
+    conn->hasThread = false;
+    assertok(napi_reference_unref(env, conn->wrapper_, NULL));
+    atomicAdd(&threadCount, -1);
+    unref_threadsafe_func(env, conn->ed);
     dm(conn, PQfinish);
     PQfinish(conn->pq);
     conn->pq = NULL;
+    clearResult(conn);
+    freeJobs(env, conn);
     dm(conn, unlock);
     dm(conn, destroy);
     uv_sem_destroy(&conn->sem);
-  }
+  } else
+    unlockConn();
 }
 
 static Conn* _getConn(napi_env env, napi_callback_info info) {
@@ -196,10 +297,112 @@ static Conn* _getConn(napi_env env, napi_callback_info info) {
 }
 #define getConn() Conn* conn = _getConn(env, info);
 
-static napi_value convertResult(napi_env env, Conn* conn) {
+static napi_value parserError(napi_env env) {
+  napi_value error = NULL;
+  assertok(napi_get_and_clear_last_exception(env, &error));
+  napi_value msg = NULL;
+  if (! isError(error) && jsok(napi_coerce_to_string(env, error, &msg)))
+    assertok(napi_create_error(env, NULL, msg, &error));
+  return error;
+}
+
+static void releaseRows(napi_env env, Conn* conn) {
+  if (conn->rowsRef != NULL) {
+    assertok(napi_delete_reference(env, conn->rowsRef));
+    conn->rowsRef = NULL;
+  }
+  conn->convertRow = 0;
+}
+
+/* Convert rows until all are done, returning the array, or until a slice budget is used up,
+   returning NULL; the next call continues from where this one stopped. */
+static napi_value convertRows(napi_env env, Conn* conn, uint64_t deadline) {
+  PGresult* value = conn->result;
+  int row = conn->convertRow, col;
+  const int rowCount = PQntuples(value);
+  const int cCount = PQnfields(value);
+  napi_value line, cell;
+  EnvData* ed = conn->ed;
+  napi_value names[cCount], parsers[cCount];
+  Oid types[cCount];
+  TypeConverter converters[cCount];
+  InternTable interns[cCount];
+  int64_t bytes = 0;
+  int cells = 0;
+  napi_value result;
+  if (conn->rowsRef == NULL)
+    result = makeArray(rowCount);
+  else
+    result = getRef(conn->rowsRef);
+  const int end = ed->sliceRows == 0 || rowCount - row <= ed->sliceRows
+    ? rowCount : row + ed->sliceRows;
+
+  if (conn->binary && conn->hold == NULL)
+    conn->hold = holdResult(value, conn->resultSize);
+
+  for(col = 0; col < cCount; ++col) {
+    const Oid type = types[col] = PQftype(value, col);
+    names[col] = makeAutoString(PQfname(value, col));
+    parsers[col] = conn->raw ? NULL : getTypeParser(env, &ed->typeParsers, type);
+    converters[col] = typeConverter(type, &ed->typeModes);
+    if (parsers[col] != NULL && converters[col].t == convertDate) converters[col].t = convertDateMs;
+    internInit(&interns[col], conn->raw || conn->binary ? 0 : ed->internMaxLen,
+               &converters[col], parsers[col]);
+  }
+  while (row < end) {
+    line = makeObject();
+    for(col = 0; col < cCount; ++col) {
+      if (! PQgetisnull(value, row, col)) {
+        const int len = PQgetlength(value, row, col);
+        char* text = PQgetvalue(value, row, col);
+        bytes += len;
+        if (conn->binary)
+          cell = conn->raw ? makeView(env, conn->hold, text, len)
+            : convertBinary(env, conn->hold, types[col], &converters[col], parsers[col], text, len);
+        else if (conn->raw)
+          cell = jsok(napi_create_buffer_copy(env, len, text, NULL, &cell)) ? cell : NULL;
+        else
+          cell = internCell(env, &interns[col], &converters[col], parsers[col], text, len);
+        if (cell == NULL || ! jsok(napi_set_property(env, line, names[col], cell))) {
+          for(col = 0; col < cCount; ++col) internFree(&interns[col]);
+          releaseRows(env, conn);
+          return parserError(env);
+        }
+      }
+    }
+    addValue(result, row++, line);
+    if ((cells += cCount) >= SLICE_CHECK_CELLS) {
+      cells = 0;
+      if (uv_hrtime() >= deadline) break;
+    }
+  }
+  for(col = 0; col < cCount; ++col) internFree(&interns[col]);
+  conn->resultBytes += bytes;
+  if (row < rowCount) {
+    conn->convertRow = row;
+    if (conn->rowsRef == NULL)
+      assertok(napi_create_reference(env, result, 1, &conn->rowsRef));
+    return NULL;
+  }
+  releaseRows(env, conn);
+  conn->resultRows = rowCount;
+  return result;
+}
+
+/* Read on the connection thread: once jobs are queued only that thread may touch the PGconn.
+   Non-NULL whenever the connection is bad; the message is used when there is no result. */
+static char* lostConnectionError(PGconn* pq, Arena* arena) {
+  if (PQstatus(pq) != CONNECTION_BAD) return NULL;
+  const char* msg = PQerrorMessage(pq);
+  const size_t len = strlen(msg) + 1;
+  return memcpy(arenaAlloc(arena, len), msg, len);
+}
+
+static napi_value convertResult(napi_env env, Conn* conn, uint64_t deadline) {
   PGresult* value = conn->result;
   const napi_value null = getNull();
-  if (value == NULL) return null;
+  if (value == NULL)
+    return conn->connError != NULL ? makeError(conn->connError) : null;
   napi_value result = null;
   switch(PQresultStatus(value)) {
   case PGRES_EMPTY_QUERY: break;
@@ -219,116 +422,250 @@ static napi_value convertResult(napi_env env, Conn* conn) {
     conn->copy_inprogress = 1;
     return result;
   }
-  case PGRES_COPY_OUT: {
+  case PGRES_COPY_OUT: case PGRES_COPY_BOTH: {
     conn->copy_inprogress = 2;
     return result;
   }
-  default: {
-    int row, col;
-    const int64_t rowCount = PQntuples(value);
-    const int64_t cCount = PQnfields(value);
-    napi_value line;
-    result = makeArray(2);
-    const napi_value colData = makeArray(cCount);
-    addValue(result, 0, colData);
-    const napi_value rows = makeArray(rowCount);
-    addValue(result, 1, rows);
-
-    for(col = 0; col < cCount; ++col) {
-      line = makeArray(2);
-      addValue(line, 0, makeAutoString(PQfname(value, col)));
-      addInt(line, 1, PQftype(value, col));
-      /* addInt32(line, 2, PQfmod(value, col)); */
-      addValue(colData, col, line);
-    }
-    for(row = 0; row < rowCount; ++row) {
-      line = makeObject();
-      for(col = 0; col < cCount; ++col) {
-        if (! PQgetisnull(value, row, col))
-          setProperty(line, PQfname(value, col),
-                      convert(env, PQftype(value, col), PQgetvalue(value, row, col),
-                              PQgetlength(value, row, col)));
-      }
-      addValue(rows, row, line);
-    }
-    return result;
-  }
+  default:
+    return convertRows(env, conn, deadline);
   }
 
-  return makeError(PQerrorMessage(conn->pq));
+  return makeError(PQresultErrorMessage(value));
 }
 
 
-static void async_execute(void* data) {
+static void queueWaiting(Conn* conn) {
+  ConnQueue* waitingQueue = &conn->ed->waitingQueue;
+  uv_mutex_lock(&waitingQueue->lock);
+  if (waitingQueue->head == NULL)
+    napi_call_threadsafe_function(conn->ed->threadsafe_func, NULL, napi_tsfn_nonblocking);
+  queueAddConn(waitingQueue, conn);
+  uv_mutex_unlock(&waitingQueue->lock);
+}
+
+/* Hand the oldest job to async_complete once it has run and the previous one is done with. */
+static bool takeJob(Conn* conn) {
+  Job* job = conn->jobs;
+  if (conn->active != NULL || job == NULL || ! job->executed) return false;
+  conn->active = job;
+  conn->jobs = job->next;
+  if (conn->jobs == NULL) conn->jobsTail = NULL;
+  return true;
+}
+
+static void executeJob(Conn* conn, Job* job) {
+  PGconn* pq = conn->pq;
+  unlockConn();
+  job->stat = NULL;
+  job->timings[TIMING_EXEC_START] = uv_hrtime();
+  job->result = job->execute(pq, job);
+  job->timings[TIMING_EXEC_END] = uv_hrtime();
+  job->connError = lostConnectionError(pq, &job->arena);
+  if (job->result != NULL) {
+    job->resultSize = resultMemorySize(job->result);
+    atomicAdd(&resultBytes, job->resultSize);
+    atomicAdd(&resultBytesTotal, job->resultSize);
+  }
   lockConn();
+  if (job->stat != NULL)
+    statsRecordExec(job->stat, &conn->counters, job->result,
+                    job->timings[TIMING_EXEC_END] - job->timings[TIMING_EXEC_START]);
+}
 
+static void async_execute(void* data) {
   Conn* conn = data;
+
   uv_sem_t* sem = &conn->sem;
   while(true) {
-    unlockConn();
     dm(conn, wait);
     uv_sem_wait(sem);
     lockConn();
-    if (conn->state != PGLIBPQ_STATE_BUSY) {
+    Job* job = conn->nextJob;
+    if (job != NULL) {
+      /* After finish() the remaining jobs are skipped; async_complete fails them. */
+      if (conn->state == PGLIBPQ_STATE_BUSY) {
+        conn->nextJob = job->next;
+        executeJob(conn, job);
+      } else if (conn->state == PGLIBPQ_STATE_ABORT)
+        conn->nextJob = job->next;
+      if (conn->state != PGLIBPQ_STATE_BUSY && conn->state != PGLIBPQ_STATE_ABORT) {
+        unlockConn();
+        return;
+      }
+      job->executed = true;
+      const bool handoff = takeJob(conn);
+      unlockConn();
+      if (handoff) queueWaiting(conn);
+      continue;
+    }
+    /* finish() before the job started still needs its completion to clean up. */
+    if (conn->state == PGLIBPQ_STATE_BUSY) {
+      conn->stat = NULL;
+      conn->timings[TIMING_EXEC_START] = uv_hrtime();
+      conn->execute(conn);
+      conn->timings[TIMING_EXEC_END] = uv_hrtime();
+      conn->connError = lostConnectionError(conn->pq, &conn->arena);
+      if (conn->result != NULL) {
+        conn->resultSize = resultMemorySize(conn->result);
+        atomicAdd(&resultBytes, conn->resultSize);
+        atomicAdd(&resultBytesTotal, conn->resultSize);
+      }
+      if (conn->stat != NULL)
+        statsRecordExec(conn->stat, &conn->counters, conn->result,
+                        conn->timings[TIMING_EXEC_END] - conn->timings[TIMING_EXEC_START]);
+    } else if (conn->state != PGLIBPQ_STATE_ABORT) {
       unlockConn();
       return;
     }
-    conn->execute(conn);
-    uv_mutex_lock(&waitingQueue.lock);
-    if (waitingQueue.head == NULL)
-      napi_call_threadsafe_function(threadsafe_func, NULL, napi_tsfn_nonblocking);
-    queueAddConn(&waitingQueue, conn);
-    uv_mutex_unlock(&waitingQueue.lock);
+    /* finish() holds the queue lock while joining a thread that may need this lock. */
+    unlockConn();
+    queueWaiting(conn);
   }
 }
 
-void async_complete(napi_env env, napi_status status, void* data) {
-  Conn* conn = data;
+static void loadJob(Conn* conn) {
+  Job* job = conn->active;
+  clearResult(conn);
+  conn->request = job->request;
+  conn->complete = job->complete;
+  conn->callback_ref = job->callback_ref;
+  job->callback_ref = NULL;
+  conn->raw = job->raw;
+  conn->binary = job->binary;
+  conn->result = job->result;
+  conn->resultSize = job->resultSize;
+  conn->connError = job->connError;
+  job->result = NULL;
+  conn->stat = job->stat;
+  memcpy(conn->timings, job->timings, sizeof(conn->timings));
+}
+
+static void recycleJob(Conn* conn, Job* job) {
+  arenaReset(&job->arena);
+  job->next = conn->spareJobs;
+  conn->spareJobs = job;
+  --conn->jobCount;
+}
+
+/* Returns false if the result is only partly converted and needs another slice. */
+static bool async_complete(napi_env env, Conn* conn, uint64_t deadline) {
   lockConn();
+  if (conn->active != NULL && conn->callback_ref == NULL) loadJob(conn);
   bool isAbort = conn->state == PGLIBPQ_STATE_ABORT;
+  /* Type parsers are user code that may call back into this client, so convert unlocked; the
+     connection thread no longer touches conn->result once it is handed over. */
+  unlockConn();
 
+  const uint64_t start = uv_hrtime();
+  if (conn->rowsRef == NULL) {
+    conn->timings[TIMING_COMPLETE] = start;
+    conn->resultRows = conn->resultBytes = 0;
+    conn->convertNs = 0;
+  }
   const napi_value null = getNull();
-  napi_value result = isAbort ? makeError("connection is closed") : convertResult(env, conn);
+  napi_value result;
+  if (isAbort) {
+    releaseRows(env, conn);
+    result = makeError("connection is closed");
+  } else
+    result = convertResult(env, conn, deadline);
+  const uint64_t end = uv_hrtime();
+  conn->convertNs += end - start;
+  if (result == NULL) return false;
   const bool err = isError(result);
+  conn->timings[TIMING_CONVERT_END] = end;
 
   napi_value cb_args[] = {err ? result : null, err ? null : result};
 
   conn->complete(env, conn, cb_args);
+  if (! isAbort && isError(cb_args[0])) {
+    /* Read now; the next queued job may replace conn->result before the callback asks. */
+    char* sqlState = conn->result == NULL
+      ? NULL : PQresultErrorField(conn->result, PG_DIAG_SQLSTATE);
+    if (sqlState != NULL) setProperty(cb_args[0], "sqlState", makeAutoString(sqlState));
+    if (conn->connError != NULL) setProperty(cb_args[0], "connectionBad", makeBoolean(true));
+  }
+
+  lockConn();
+  if (conn->stat != NULL)
+    histRecord(&conn->stat->convert, conn->convertNs);
+  /* A parser may have called finish() while the result was converted. */
+  isAbort = isAbort || conn->state == PGLIBPQ_STATE_ABORT;
 
   if (! err) clearResult(conn);
 
 
-  if (conn->request != NULL) {
-    free(conn->request);
-    conn->request = NULL;
-  }
+  conn->request = NULL;
+  conn->connError = NULL;
+  if (conn->active != NULL) {
+    recycleJob(conn, conn->active);
+    conn->active = NULL;
+  } else
+    arenaReset(&conn->arena);
 
   napi_value callback = getRef(conn->callback_ref);
   freeCallbackRef(env, conn);
 
+  napi_value failed[JOB_QUEUE_DEPTH];
+  int failedCount = 0;
+  bool handoff = false;
   if (isAbort) {
     dm(conn, isAbort);
+    for(Job* job = conn->jobs; job != NULL; job = job->next)
+      failed[failedCount++] = getRef(job->callback_ref);
+    /* Stops the connection thread handing off the remaining jobs before cleanup joins it. */
+    conn->state = PGLIBPQ_STATE_ERROR;
     unlockConn();
     cleanup(env, conn);
   } else {
-    conn->state = PGLIBPQ_STATE_READY;
+    handoff = takeJob(conn);
+    if (conn->active == NULL && conn->jobs == NULL) conn->state = PGLIBPQ_STATE_READY;
     unlockConn();
   }
+  if (handoff) queueWaiting(conn);
   callFunction(getGlobal(), callback, 2, cb_args);
+  for(int i = 0; i < failedCount; ++i) {
+    napi_value args[] = {makeError("connection is closed"), null};
+    callFunction(getGlobal(), failed[i], 2, args);
+  }
+  return true;
 }
 
+/* Complete waiting connections until the slice budget is used up, then yield to the event loop
+   and continue on the next turn; partly converted results go to the back of the queue. */
 static void runCallbacks(napi_env env, napi_value js_callback, void* context, void* data) {
+  if (env == NULL) return;
+  EnvData* ed = context;
+  ConnQueue* waitingQueue = &ed->waitingQueue;
+  const uint64_t deadline = ed->sliceNs == 0 ? UINT64_MAX : uv_hrtime() + ed->sliceNs;
   Conn* conn;
-  while((conn = queueRmHead(&waitingQueue))) {
-    async_complete(env, 0, conn);
+  while((conn = queueRmHead(waitingQueue))) {
+    napi_handle_scope scope;
+    assertok(napi_open_handle_scope(env, &scope));
+    const bool done = async_complete(env, conn, deadline);
+    assertok(napi_close_handle_scope(env, scope));
+    bool pending;
+    assertok(napi_is_exception_pending(env, &pending));
+    if (! done || pending || uv_hrtime() >= deadline) {
+      uv_mutex_lock(&waitingQueue->lock);
+      if (! done) queueAddConn(waitingQueue, conn);
+      if (waitingQueue->head != NULL)
+        napi_call_threadsafe_function(ed->threadsafe_func, NULL, napi_tsfn_nonblocking);
+      uv_mutex_unlock(&waitingQueue->lock);
+      return;
+    }
   }
 }
 
 static void queueJob(napi_env env, Conn* conn) {
-  if (conn->pq == NULL) {
+  if (! conn->hasThread) {
     dm(conn, init);
+    /* The thread and its completions use conn, so keep it from being collected until cleanup. */
+    assertok(napi_reference_ref(env, conn->wrapper_, NULL));
     uv_sem_init(&conn->sem, 1);
-    ref_threadsafe_func(env);
+    ref_threadsafe_func(env, conn->ed);
+    atomicAdd(&threadCount, 1);
+    conn->hasThread = true;
     uv_thread_create(&conn->thread, async_execute, conn);
   } else {
     dm(conn, post);
@@ -345,6 +682,8 @@ static napi_value runAsync(napi_env env, napi_callback_info info,
   ASSERT_STATE(conn, READY);
   conn->state = PGLIBPQ_STATE_BUSY;
   clearResult(conn);
+  conn->raw = conn->binary = false;
+  traceTime(conn, SUBMIT);
 
   conn->execute = execute;
   conn->complete = complete;
@@ -355,12 +694,89 @@ static napi_value runAsync(napi_env env, napi_callback_info info,
   assertok(napi_create_reference(env, args[argc-1], 1, &conn->callback_ref));
   napi_value result = init(env, info, conn, argc, args);
 
+  bool pending;
+  assertok(napi_is_exception_pending(env, &pending));
+  if (pending) {
+    conn->state = PGLIBPQ_STATE_READY;
+    freeCallbackRef(env, conn);
+    conn->request = NULL;
+    arenaReset(&conn->arena);
+    unlockConn();
+    return NULL;
+  }
+
+  queueJob(env, conn);
+
+  unlockConn();
+  return result;
+}
+
+static Job* newJob(Conn* conn) {
+  Job* job = conn->spareJobs;
+  if (job != NULL)
+    conn->spareJobs = job->next;
+  else
+    job = countedCalloc(1, sizeof(Job));
+  job->next = NULL;
+  job->request = NULL;
+  job->stat = NULL;
+  job->connError = NULL;
+  job->raw = job->binary = job->executed = false;
+  ++conn->jobCount;
+  return job;
+}
+
+/* Like runAsync, but a query may be queued behind up to JOB_QUEUE_DEPTH-1 other queued queries
+   still running or being converted, so the server is not left idle during conversion. */
+static napi_value runQueued(napi_env env, napi_callback_info info, size_t argc,
+                            conn_job_init init, conn_job_execute execute,
+                            conn_async_complete complete) {
+  getConn();
+  lockConn();
+  const bool queued = conn->active != NULL || conn->jobs != NULL;
+  if (conn->copy_inprogress != 0 || conn->jobCount >= JOB_QUEUE_DEPTH ||
+      (conn->state != PGLIBPQ_STATE_READY && ! (conn->state == PGLIBPQ_STATE_BUSY && queued))) {
+    unlockConn();
+    throwStateError(env, "READY");
+    return NULL;
+  }
+  Job* job = newJob(conn);
+  job->execute = execute;
+  job->complete = complete;
+  if (conn->trace) job->timings[TIMING_SUBMIT] = uv_hrtime();
+
+  napi_value args[argc];
+  assertok(napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  napi_value result = init(env, job, argc, args);
+
+  bool pending;
+  assertok(napi_is_exception_pending(env, &pending));
+  if (pending) {
+    recycleJob(conn, job);
+    unlockConn();
+    return NULL;
+  }
+  assertok(napi_create_reference(env, args[argc-1], 1, &job->callback_ref));
+
+  if (conn->jobsTail == NULL)
+    conn->jobs = job;
+  else
+    conn->jobsTail->next = job;
+  conn->jobsTail = job;
+  if (conn->nextJob == NULL) conn->nextJob = job;
+  conn->state = PGLIBPQ_STATE_BUSY;
+
   queueJob(env, conn);
 
   unlockConn();
   return result;
 }
 
+#define defQueued(name, argc)                                           \
+  napi_value name(napi_env env, napi_callback_info info) {              \
+    return runQueued(env, info, argc, init_ ## name, exec_ ## name, done_ ## name); \
+  }
+
 #define defAsync(name, argc)                                            \
   napi_value name(napi_env env, napi_callback_info info) {              \
     return runAsync(env, info, quote(pg-libpq_ ## name), argc,          \
@@ -0,0 +1,180 @@
+/* Logical replication on a COPY_BOTH stream. The thread reuses GetData from copy-to-stream.h
+   but delivers one XLogData message per read and answers the server with standby status
+   updates, confirming gd->flushed. That is raised without the connection lock because the
+   stream acknowledges from inside pushCopyData. */
+
+/* Microseconds between the unix and the postgres epoch (2000-01-01). */
+#define PG_EPOCH_OFFSET_US 946684800000000LL
+#define REPLICATION_POLL_MS 100
+
+static void writeUint64(char* data, uint64_t value) {
+  for (int i = 7; i >= 0; --i) {
+    data[i] = (char)(value & 0xff);
+    value >>= 8;
+  }
+}
+
+static void raiseFlushed(GetData* gd, int64_t lsn) {
+  int64_t flushed;
+  while (lsn > (flushed = atomicGet(&gd->flushed)) && ! atomicCas(&gd->flushed, flushed, lsn));
+}
+
+static int sendStatus(PGconn* pq, int64_t flushed) {
+  char msg[34];
+  uv_timeval64_t tv;
+  uv_gettimeofday(&tv);
+  msg[0] = 'r';
+  writeUint64(msg + 1, flushed);
+  writeUint64(msg + 9, flushed);
+  writeUint64(msg + 17, flushed);
+  writeUint64(msg + 25, tv.tv_sec * 1000000 + tv.tv_usec - PG_EPOCH_OFFSET_US);
+  msg[33] = 0;
+  if (PQputCopyData(pq, msg, sizeof(msg)) != 1) return -1;
+  return PQflush(pq);
+}
+
+static char* copyMessage(const char* msg) {
+  const size_t len = strlen(msg) + 1;
+  return memcpy(countedMalloc(len), msg, len);
+}
+
+/* Collect the results ending the stream; returns the error, if any, that ended it. */
+static char* replicationEndError(PGconn* pq, int size) {
+  char* error = size == -2 ? copyMessage(PQerrorMessage(pq)) : NULL;
+  PGresult* result;
+  while ((result = PQgetResult(pq)) != NULL) {
+    if (error == NULL && PQresultStatus(result) == PGRES_FATAL_ERROR)
+      error = copyMessage(PQresultErrorMessage(result));
+    PQclear(result);
+  }
+  return error;
+}
+
+static void async_getReplicationData(void* data) {
+  GetData *gd = data;
+  Conn* conn = gd->conn;
+  PGconn* pq = conn->pq;
+  const uint64_t interval = (uint64_t)gd->statusMs * 1000000;
+  uint64_t nextStatus = uv_hrtime() + interval;
+  char* buffer = NULL;
+  int size = 0;
+
+  lockConn();
+  for (;;) {
+    while (gd->state == 1 || (gd->state == 0 && gd->readSize == 0)) {
+      const uint64_t now = uv_hrtime();
+      if (now >= nextStatus) {
+        const int64_t flushed = atomicGet(&gd->flushed);
+        unlockConn();
+        sendStatus(pq, flushed);
+        lockConn();
+        nextStatus = now + interval;
+        continue;
+      }
+      uv_cond_timedwait(&gd->cond, &conn->ed->lock, nextStatus - now);
+    }
+    if (gd->state == 2) break;
+    gd->readSize = 0;
+
+    for (;;) {
+      unlockConn();
+      size = PQgetCopyData(pq, &buffer, 1);
+      if (size == 0) {
+        const uint64_t now = uv_hrtime();
+        int ms = REPLICATION_POLL_MS;
+        if (now >= nextStatus)
+          ms = 0;
+        else if (nextStatus - now < (uint64_t)ms * 1000000)
+          ms = (int)((nextStatus - now) / 1000000);
+        if (ms > 0 && waitSocket(PQsocket(pq), true, ms) < 0)
+          size = -2;
+        else if (PQconsumeInput(pq) == 0)
+          size = -2;
+      } else if (size > 0) {
+        atomicAdd(&conn->counters.bytesReceived, size);
+      }
+      char* error = size < 0 ? replicationEndError(pq, size) : NULL;
+      lockConn();
+      if (error != NULL) gd->error = error;
+
+      if (gd->state == 2 || size < 0) break;
+
+      if (size == 0) {
+        const uint64_t now = uv_hrtime();
+        if (now >= nextStatus) {
+          const int64_t flushed = atomicGet(&gd->flushed);
+          unlockConn();
+          sendStatus(pq, flushed);
+          lockConn();
+          nextStatus = now + interval;
+        }
+        continue;
+      }
+
+      if (buffer[0] == 'k' && size >= 18) {
+        const int64_t walEnd = (int64_t)readUint64(buffer + 1);
+        const bool reply = buffer[17] != 0;
+        if (atomicGet(&gd->flushed) >= gd->pushed)
+          raiseFlushed(gd, walEnd);
+        const int64_t flushed = atomicGet(&gd->flushed);
+        PQfreemem(buffer);
+        buffer = NULL;
+        if (reply) {
+          unlockConn();
+          sendStatus(pq, flushed);
+          lockConn();
+          nextStatus = uv_hrtime() + interval;
+        }
+        continue;
+      }
+
+      if (buffer[0] == 'w' && size >= 25) {
+        gd->pushed = (int64_t)readUint64(buffer + 1);
+        gd->data = countedMalloc(size);
+        memcpy(gd->data, buffer, size);
+        gd->length = size;
+        gd->result = size;
+      }
+      PQfreemem(buffer);
+      buffer = NULL;
+      if (gd->length != 0) break;
+    }
+
+    if (gd->state == 2) break;
+
+    if (size < 0) {
+      gd->length = 0;
+      gd->result = -1;
+    }
+    gd->state = 1;
+    napi_status status = napi_call_threadsafe_function(gd->threadsafe_func, NULL,
+                                                       napi_tsfn_nonblocking);
+    assert(status == napi_ok);
+    if (size < 0) break;
+  }
+
+  if (buffer) PQfreemem(buffer);
+  const int64_t flushed = atomicGet(&gd->flushed);
+  unlockConn();
+
+  if (size >= 0 && sendStatus(pq, flushed) == 0 &&
+      PQputCopyEnd(pq, NULL) == 1 && PQflush(pq) == 0) {
+    while ((size = PQgetCopyData(pq, &buffer, 0)) > 0)
+      PQfreemem(buffer);
+  }
+  PGresult* result;
+  while ((result = PQgetResult(pq)) != NULL)
+    PQclear(result);
+}
+
+static napi_value acknowledgeLsn(napi_env env, napi_callback_info info) {
+  getConn();
+  getArgs(1);
+  int64_t lsn;
+  bool lossless;
+  assertok(napi_get_value_bigint_int64(env, args[0], &lsn, &lossless));
+  GetData *gd = conn->request;
+  if (conn->copy_inprogress == 2 && gd != NULL && gd->replication)
+    raiseFlushed(gd, lsn);
+  return NULL;
+}
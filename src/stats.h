@@ -0,0 +1,314 @@
+#include <ctype.h>
+
+/* Log-linear histogram of microseconds: 16 sub-buckets per power of two, exact below 32. */
+#define HIST_SUB_BITS 4
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS 32
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB)
+
+#define STATS_SLOTS 256
+#define STATS_KEY_SIZE 128
+#define ERROR_SLOTS 64
+
+typedef struct {
+  int64_t count;
+  int64_t sum;
+  int64_t max;
+  int64_t buckets[HIST_BUCKETS];
+} Histogram;
+
+typedef struct {
+  int64_t hash;
+  int64_t ready;
+  bool prepared;
+  char key[STATS_KEY_SIZE];
+  int64_t calls;
+  int64_t rows;
+  int64_t errors;
+  Histogram exec;
+  Histogram convert;
+} StatEntry;
+
+typedef struct {
+  int64_t queries;
+  int64_t rows;
+  int64_t bytesSent;
+  int64_t bytesReceived;
+  int64_t errors;
+} ConnCounters;
+
+static StatEntry statEntries[STATS_SLOTS];
+static StatEntry statOverflow = {.hash = 1, .ready = 1, .key = "(other)"};
+static int64_t errorCodes[ERROR_SLOTS], errorCounts[ERROR_SLOTS];
+
+static int highBit(uint64_t v) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse64(&index, v);
+  return (int)index;
+#else
+  return 63 - __builtin_clzll(v);
+#endif
+}
+
+static int histIndex(uint64_t v) {
+  if (v < 2*HIST_SUB) return (int)v;
+  if (v >= (uint64_t)1 << HIST_MAX_BITS) v = ((uint64_t)1 << HIST_MAX_BITS) - 1;
+  int shift = highBit(v) - HIST_SUB_BITS;
+  return (shift+1)*HIST_SUB + (int)(v >> shift) - HIST_SUB;
+}
+
+static uint64_t histLowerBound(int index) {
+  if (index < 2*HIST_SUB) return index;
+  int shift = index/HIST_SUB - 1;
+  return (uint64_t)(index % HIST_SUB + HIST_SUB) << shift;
+}
+
+static void histRecord(Histogram* hist, uint64_t ns) {
+  int64_t us = (int64_t)(ns / 1000);
+  atomicAdd(&hist->count, 1);
+  atomicAdd(&hist->sum, us);
+  atomicAdd(&hist->buckets[histIndex(us)], 1);
+  int64_t max = atomicGet(&hist->max);
+  while (us > max && ! atomicCas(&hist->max, max, us))
+    max = atomicGet(&hist->max);
+}
+
+#define isIdentChar(c) (isalnum((unsigned char)c) || c == '_' || c == '$' || (c & 0x80))
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+#define keyAddChar(c) {                                 \
+    hash = (hash ^ (u_char)(c)) * FNV_PRIME;            \
+    if (len < STATS_KEY_SIZE-1) key[len] = c;           \
+    ++len;                                              \
+  }
+
+/* Copy sql into key with literals replaced by ? and comments and extra whitespace removed;
+   returns the hash of the whole normalised text. */
+static uint64_t normaliseSql(const char* sql, char* key) {
+  uint64_t hash = FNV_OFFSET;
+  size_t len = 0;
+  bool space = false;
+  char prev = 0;
+  const char* p = sql;
+  while (*p) {
+    char c = *p;
+    if (isspace((unsigned char)c)) {
+      space = len != 0;
+      ++p;
+      continue;
+    }
+    if (c == '-' && p[1] == '-') {
+      while (*p && *p != '\n') ++p;
+      continue;
+    }
+    if (c == '/' && p[1] == '*') {
+      p += 2;
+      while (*p && ! (*p == '*' && p[1] == '/')) ++p;
+      if (*p) p += 2;
+      continue;
+    }
+    if (space) {
+      keyAddChar(' ');
+      space = false;
+      prev = ' ';
+    }
+    if (c == '\'') {
+      for(++p; *p; ++p) {
+        if (*p == '\'') {
+          if (p[1] != '\'') break;
+          ++p;
+        }
+      }
+      if (*p) ++p;
+      c = '?';
+    } else if (c == '"') {
+      keyAddChar(c);
+      for(++p; *p && *p != '"'; ++p) keyAddChar(*p);
+      if (*p) ++p;
+    } else if ((isdigit((unsigned char)c) || (c == '.' && isdigit((unsigned char)p[1])))
+               && ! isIdentChar(prev)) {
+      while (isdigit((unsigned char)*p) || *p == '.') ++p;
+      if ((*p == 'e' || *p == 'E') &&
+          (isdigit((unsigned char)p[1]) ||
+           ((p[1] == '+' || p[1] == '-') && isdigit((unsigned char)p[2])))) {
+        p += 2;
+        while (isdigit((unsigned char)*p)) ++p;
+      }
+      c = '?';
+    } else {
+      ++p;
+    }
+    keyAddChar(c);
+    prev = c;
+  }
+  key[len < STATS_KEY_SIZE ? len : STATS_KEY_SIZE-1] = 0;
+  return hash;
+}
+
+static uint64_t hashName(const char* name, char* key) {
+  uint64_t hash = FNV_OFFSET;
+  size_t len = 0;
+  for(; *name; ++name) keyAddChar(*name);
+  key[len < STATS_KEY_SIZE ? len : STATS_KEY_SIZE-1] = 0;
+  return hash;
+}
+
+/* Find or claim the entry for a statement name or, when name is NULL, the normalised sql. */
+static StatEntry* statsLookup(const char* sql, const char* name) {
+  char key[STATS_KEY_SIZE];
+  const bool prepared = name != NULL;
+  int64_t hash = prepared ? (int64_t)(hashName(name, key) * FNV_PRIME)
+    : (int64_t)normaliseSql(sql, key);
+  if (hash == 0) hash = 1;
+
+  for(int i = 0; i < STATS_SLOTS; ++i) {
+    StatEntry* entry = &statEntries[(hash + i) & (STATS_SLOTS-1)];
+    int64_t current = atomicGet(&entry->hash);
+    if (current == 0 && atomicCas(&entry->hash, 0, hash)) {
+      entry->prepared = prepared;
+      strcpy(entry->key, key);
+      atomicSet(&entry->ready, 1);
+      return entry;
+    }
+    if (atomicGet(&entry->hash) == hash) return entry;
+  }
+  return &statOverflow;
+}
+
+static void countError(const char* sqlState) {
+  int64_t code = 0;
+  if (sqlState != NULL) memcpy(&code, sqlState, strnlen(sqlState, 5));
+  if (code == 0) code = 1;
+  for(int i = 0; i < ERROR_SLOTS; ++i) {
+    int slot = ((int)((uint64_t)code * FNV_PRIME >> 58) + i) & (ERROR_SLOTS-1);
+    int64_t current = atomicGet(&errorCodes[slot]);
+    if (current == code || (current == 0 && atomicCas(&errorCodes[slot], 0, code))
+        || atomicGet(&errorCodes[slot]) == code) {
+      atomicAdd(&errorCounts[slot], 1);
+      return;
+    }
+  }
+}
+
+/* Called on the connection thread, with the connection lock held, once the result of a query is
+   available. */
+static void statsRecordExec(StatEntry* entry, ConnCounters* counters, PGresult* result,
+                            uint64_t ns) {
+  int64_t rows = 0;
+  bool error = false;
+  switch(result == NULL ? PGRES_FATAL_ERROR : PQresultStatus(result)) {
+  case PGRES_TUPLES_OK:
+    rows = PQntuples(result);
+    break;
+  case PGRES_COMMAND_OK:
+    rows = atoll(PQcmdTuples(result));
+    break;
+  case PGRES_BAD_RESPONSE: case PGRES_FATAL_ERROR:
+    error = true;
+    countError(result == NULL ? NULL : PQresultErrorField(result, PG_DIAG_SQLSTATE));
+    break;
+  default:
+    break;
+  }
+
+  atomicAdd(&counters->queries, 1);
+  atomicAdd(&counters->rows, rows);
+  atomicAdd(&entry->calls, 1);
+  atomicAdd(&entry->rows, rows);
+  if (error) {
+    atomicAdd(&counters->errors, 1);
+    atomicAdd(&entry->errors, 1);
+  }
+  histRecord(&entry->exec, ns);
+}
+
+static napi_value _histSnapshot(napi_env env, Histogram* hist) {
+  int64_t counts[HIST_BUCKETS];
+  int64_t count = 0;
+  uint32_t used = 0;
+  for(int i = 0; i < HIST_BUCKETS; ++i) {
+    counts[i] = atomicGet(&hist->buckets[i]);
+    count += counts[i];
+    if (counts[i] != 0) ++used;
+  }
+  const int64_t max = atomicGet(&hist->max);
+  const double quantiles[] = {0.5, 0.9, 0.99};
+  const char* names[] = {"p50", "p90", "p99"};
+  int64_t seen = 0;
+  int q = 0;
+
+  napi_value result = makeObject();
+  napi_value buckets = makeArray(used);
+  used = 0;
+  for(int i = 0; i < HIST_BUCKETS; ++i) {
+    if (counts[i] == 0) continue;
+    int64_t upper = (int64_t)histLowerBound(i+1) - 1;
+    seen += counts[i];
+    for(; q < 3 && seen >= quantiles[q]*count; ++q)
+      setProperty(result, names[q], makeInt(upper < max ? upper : max));
+    napi_value bucket = makeArray(2);
+    addInt(bucket, 0, upper);
+    addInt(bucket, 1, counts[i]);
+    addValue(buckets, used++, bucket);
+  }
+  for(; q < 3; ++q) setProperty(result, names[q], makeInt(0));
+  setProperty(result, "count", makeInt(count));
+  setProperty(result, "sum", makeInt(atomicGet(&hist->sum)));
+  setProperty(result, "max", makeInt(max));
+  setProperty(result, "buckets", buckets);
+  return result;
+}
+#define histSnapshot(hist) _histSnapshot(env, hist)
+
+static napi_value _statEntrySnapshot(napi_env env, StatEntry* entry) {
+  napi_value result = makeObject();
+  setProperty(result, "key", makeAutoString(entry->key));
+  setProperty(result, "prepared", makeBoolean(entry->prepared));
+  setProperty(result, "calls", makeInt(atomicGet(&entry->calls)));
+  setProperty(result, "rows", makeInt(atomicGet(&entry->rows)));
+  setProperty(result, "errors", makeInt(atomicGet(&entry->errors)));
+  setProperty(result, "exec", histSnapshot(&entry->exec));
+  setProperty(result, "convert", histSnapshot(&entry->convert));
+  return result;
+}
+#define statEntrySnapshot(entry) _statEntrySnapshot(env, entry)
+
+static napi_value _statsSnapshot(napi_env env) {
+  napi_value statements = makeArray(0);
+  uint32_t n = 0;
+  for(int i = 0; i < STATS_SLOTS; ++i) {
+    StatEntry* entry = &statEntries[i];
+    if (atomicGet(&entry->ready)) addValue(statements, n++, statEntrySnapshot(entry));
+  }
+  if (atomicGet(&statOverflow.calls) != 0)
+    addValue(statements, n++, statEntrySnapshot(&statOverflow));
+
+  napi_value errors = makeObject();
+  for(int i = 0; i < ERROR_SLOTS; ++i) {
+    int64_t code = atomicGet(&errorCodes[i]);
+    if (code == 0) continue;
+    char sqlState[6] = {0};
+    if (code != 1) memcpy(sqlState, &code, 5);
+    setProperty(errors, code == 1 ? "unknown" : sqlState, makeInt(atomicGet(&errorCounts[i])));
+  }
+
+  napi_value result = makeObject();
+  setProperty(result, "statements", statements);
+  setProperty(result, "errors", errors);
+  return result;
+}
+#define statsSnapshot() _statsSnapshot(env)
+
+static napi_value _countersSnapshot(napi_env env, ConnCounters* counters) {
+  napi_value result = makeObject();
+  setProperty(result, "queries", makeInt(atomicGet(&counters->queries)));
+  setProperty(result, "rows", makeInt(atomicGet(&counters->rows)));
+  setProperty(result, "bytesSent", makeInt(atomicGet(&counters->bytesSent)));
+  setProperty(result, "bytesReceived", makeInt(atomicGet(&counters->bytesReceived)));
+  setProperty(result, "errors", makeInt(atomicGet(&counters->errors)));
+  return result;
+}
+#define countersSnapshot(counters) _countersSnapshot(env, counters)
@@ -0,0 +1,96 @@
+const PG = require('../');
+const assert = require('assert');
+const v8 = require('v8');
+const vm = require('vm');
+
+v8.setFlagsFromString('--expose-gc');
+const gc = vm.runInNewContext('gc');
+
+const collect = async ()=>{
+  for (let i = 0; i < 3; ++i) {
+    gc();
+    await new Promise(resolve => setImmediate(resolve));
+  }
+};
+
+describe('binary results', ()=>{
+  let pg;
+  before(done =>{
+    pg = new PG(done);
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  it('should decode scalar types', async ()=>{
+    const [row] = await pg.execParams(
+      `SELECT true AS b, -2::int2 AS s, -70000::int4 AS i, 26::oid AS o,
+              -99999999999999::int8 AS small, 1000000000000000::int8 AS big,
+              1.5::float4 AS f, -0.25::float8 AS d, 'ünï'::text AS t, 'v'::varchar AS v,
+              'c'::char(3) AS c, '{"a":[1]}'::json AS j, '{"b":2}'::jsonb AS jb,
+              NULL::text AS z`,
+      [], {binary: true});
+    assert.deepStrictEqual(row, {
+      b: true, s: -2, i: -70000, o: 26, small: -99999999999999, big: '1000000000000000',
+      f: 1.5, d: -0.25, t: 'ünï', v: 'v', c: 'c  ', j: {a: [1]}, jb: {b: 2},
+    });
+  });
+
+  it('should decode int2 from its two bytes', async ()=>{
+    const [row] = await pg.exec(
+      'SELECT (-32768)::int2 AS a, 32767::int2 AS b, 258::int2 AS c', {binary: true});
+    assert.deepStrictEqual(row, {a: -32768, b: 32767, c: 258});
+  });
+
+  it('should apply registered parsers to decoded values', async ()=>{
+    const int4 = PG.registerType(23, v => v * 2);
+    const bool = PG.registerType(16, v => v ? 'yes' : 'no');
+    try {
+      const [row] = await pg.exec(
+        "SELECT 21 AS i, false AS b, '2020-01-02'::date AS d", {binary: true});
+      assert.strictEqual(row.i, 42);
+      assert.strictEqual(row.b, 'no');
+      assert(Buffer.isBuffer(row.d));
+    } finally {
+      PG.registerType(23, int4);
+      PG.registerType(16, bool);
+    }
+  });
+
+  it('should return bytea and undecoded types as Buffers', async ()=>{
+    const [row] = await pg.exec(
+      `SELECT '\\x00ff10'::bytea AS b, ''::bytea AS e, '2020-01-02'::date AS d`, {binary: true});
+    assert.deepEqual(row.b, Buffer.from([0, 255, 16]));
+    assert.deepEqual(row.e, Buffer.alloc(0));
+    assert(Buffer.isBuffer(row.d));
+    assert.equal(row.d.readInt32BE(0), 7306);
+  });
+
+  it('should apply to execPrepared and combine with raw', async ()=>{
+    await pg.prepare('bin_p', 'SELECT $1::int AS i, $2::bytea AS b');
+    const [row] = await pg.execPrepared('bin_p', [7, Buffer.from('xy')], {binary: true, raw: true});
+    assert.equal(row.i.readInt32BE(0), 7);
+    assert.equal(row.b.toString(), 'xy');
+  });
+
+  it('should keep the result until the last view is collected', async ()=>{
+    await collect();
+    const before = PG.allocStats().resultBytes;
+    let rows = await pg.exec(
+      "SELECT decode(repeat('ab', 100000), 'hex') AS b FROM generate_series(1, 5)", {binary: true});
+    assert.equal(rows[4].b.length, 100000);
+    assert.equal(rows[4].b[99999], 0xab);
+    await pg.exec('SELECT 1');
+    assert(PG.allocStats().resultBytes - before >= 500000);
+    let last = rows[4].b;
+    rows = null;
+    await collect();
+    assert(PG.allocStats().resultBytes - before >= 500000);
+    assert.equal(last[0], 0xab);
+    last = null;
+    await collect();
+    assert(PG.allocStats().resultBytes - before < 500000);
+  });
+});
@@ -85,3 +85,74 @@ describe('connecting', ()=>{
      });
   });
 });
+
+describe('connection establishment', ()=>{
+  const net = require('net');
+  let server, port;
+  before(done =>{
+    server = net.createServer(socket =>{socket.on('error', ()=>{})});
+    server.listen(0, '127.0.0.1', ()=>{
+      port = server.address().port;
+      done();
+    });
+  });
+
+  after(()=>{server.close()});
+
+  it('sets client_encoding in the startup packet', async ()=>{
+    const pg = await PG.connect('client_encoding=LATIN1');
+    try {
+      assert.deepEqual(await pg.exec('SHOW client_encoding'), [{client_encoding: 'UTF8'}]);
+    } finally {
+      pg.finish();
+    }
+  });
+
+  it('honours connect_timeout', async ()=>{
+    const start = Date.now();
+    await assert.rejects(PG.connect(`host=127.0.0.1 port=${port} connect_timeout=1`),
+                         /timeout expired/);
+    assert(Date.now() - start < 3000);
+  });
+
+  it('can finish while connecting', async ()=>{
+    const pg = new PG(`host=127.0.0.1 port=${port}`, ()=>{});
+    const start = Date.now();
+    const result = pg.exec('SELECT 1');
+    pg.finish();
+    await assert.rejects(result, /connection is closed/);
+    assert(Date.now() - start < 1000);
+  });
+
+  it('connects many concurrently', async ()=>{
+    const clients = await PG.connectMany('', 5);
+    try {
+      assert.equal(clients.length, 5);
+      const pids = await Promise.all(clients.map(async pg => (await pg.exec('SELECT pg_backend_pid() AS p'))[0].p));
+      assert.equal(new Set(pids).size, 5);
+    } finally {
+      clients.forEach(pg => pg.finish());
+    }
+  });
+
+  it('closes the others when one of many fails', async ()=>{
+    const {threads} = PG.allocStats();
+    await assert.rejects(PG.connectMany('dbname=pg_libpq_no_such_db', 3), /pg_libpq_no_such_db/);
+    assert.equal(PG.allocStats().threads, threads);
+    await assert.rejects(PG.connectMany('', -1), RangeError);
+    assert.deepEqual(await PG.connectMany('', 0), []);
+  });
+
+  it('connects many with a callback', done =>{
+    PG.connectMany('', 2, (err, clients)=>{
+      try {
+        assert.ifError(err);
+        assert.equal(clients.length, 2);
+        clients.forEach(pg => pg.finish());
+        done();
+      } catch (ex) {
+        done(ex);
+      }
+    });
+  });
+});
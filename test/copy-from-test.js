@@ -93,6 +93,27 @@ describe('copy from streaming', ()=>{
     fromStream.on('error', failError);
     fromStream.pipe(dbStream).on('error', failError);
   });
+
+  it("should report rows that fail to copy", done =>{
+    const dbStream = pg.copyFromStream('COPY node_pg_test FROM STDIN WITH (FORMAT csv) ', err =>{
+      try {
+        assert.equal(err.sqlState, '22P02');
+        pg.exec('SELECT count(*)::int AS n FROM node_pg_test', (err, rows)=>{
+          try {
+            assert.ifError(err);
+            assert.deepEqual(rows, [{n: 0}]);
+            done();
+          } catch(ex) {
+            done(ex);
+          }
+        });
+      } catch(ex) {
+        done(ex);
+      }
+    });
+    dbStream.write('1,"a","2015-01-01"\n');
+    dbStream.end('x,"b","2015-01-01"\n');
+  });
 });
 
 const failError = err=>{
@@ -0,0 +1,83 @@
+const PG = require('../');
+const assert = require('assert');
+
+describe('cursor', ()=>{
+  let pg;
+  before(async ()=>{
+    pg = await PG.connect();
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  const collect = async (cursor)=>{
+    const batches = [];
+    for await (const rows of cursor) batches.push(rows.map(r => r.i));
+    return batches;
+  };
+
+  it('should iterate over batches', async ()=>{
+    const batches = await collect(
+      pg.cursor('SELECT i FROM generate_series(1, $1::int) AS i', [25], {batchSize: 10}));
+    assert.deepEqual(batches.map(b => b.length), [10, 10, 5]);
+    assert.equal(batches[2][4], 25);
+    assert.equal(pg.isReady(), true);
+    assert.deepEqual(await pg.exec('SELECT 1 AS a'), [{a: 1}]);
+  });
+
+  it('should handle exact and empty results', async ()=>{
+    assert.deepEqual(
+      await collect(pg.cursor('SELECT i FROM generate_series(1, 4) AS i', [], {batchSize: 2})),
+      [[1, 2], [3, 4]]);
+    assert.deepEqual(
+      await collect(pg.cursor('SELECT i FROM generate_series(1, 0) AS i')), []);
+  });
+
+  it('should reject a batchSize that is not a positive integer', ()=>{
+    for (const batchSize of [0, -1, 1.5, NaN, Infinity, '1; DROP TABLE x', 1e21])
+      assert.throws(()=> pg.cursor('SELECT 1', [], {batchSize}), RangeError, String(batchSize));
+    assert.equal(pg.isReady(), true);
+  });
+
+  it('should close when iteration stops early', async ()=>{
+    for await (const rows of pg.cursor('SELECT i FROM generate_series(1, 100) AS i', [],
+                                       {batchSize: 3})) {
+      assert.deepEqual(rows.map(r => r.i), [1, 2, 3]);
+      break;
+    }
+    assert.deepEqual(await pg.exec('SELECT count(*)::int AS c FROM pg_cursors'), [{c: 0}]);
+  });
+
+  it('should start its transaction before queries queued after it', async ()=>{
+    const cursor = pg.cursor('SELECT i FROM generate_series(1, 3) AS i', [], {batchSize: 2});
+    const first = cursor.next();
+    // SAVEPOINT fails outside a transaction block
+    const savepoint = pg.exec('SAVEPOINT after_cursor');
+    assert.deepEqual((await first).value.map(r => r.i), [1, 2]);
+    await savepoint;
+    assert.deepEqual((await cursor.next()).value.map(r => r.i), [3]);
+    assert.equal((await cursor.next()).done, true);
+    assert.equal(pg.isReady(), true);
+  });
+
+  it('should use an existing transaction', async ()=>{
+    await pg.exec('BEGIN');
+    try {
+      await pg.exec('CREATE TEMPORARY TABLE cursor_test (i int)');
+      await pg.exec('INSERT INTO cursor_test VALUES (1), (2), (3)');
+      assert.deepEqual(await collect(pg.cursor('SELECT i FROM cursor_test', [], {batchSize: 2})),
+                       [[1, 2], [3]]);
+      assert.deepEqual(await pg.exec('SELECT count(*)::int AS c FROM cursor_test'), [{c: 3}]);
+      assert.deepEqual(await pg.exec('SELECT count(*)::int AS c FROM pg_cursors'), [{c: 0}]);
+    } finally {
+      await pg.exec('ROLLBACK');
+    }
+  });
+
+  it('should report errors', async ()=>{
+    await assert.rejects(collect(pg.cursor('SELECT 1/0')), /division by zero/);
+    assert.deepEqual(await pg.exec('SELECT 3 AS a'), [{a: 3}]);
+  });
+});
@@ -0,0 +1,73 @@
+const PG = require('../');
+const assert = require('assert');
+const diagnostics_channel = require('diagnostics_channel');
+
+describe('diagnostics', ()=>{
+  let pg, entries;
+  const onQuery = entry =>{entries.push(entry)};
+
+  before(async ()=>{
+    pg = await PG.connect();
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  beforeEach(()=>{
+    entries = [];
+    diagnostics_channel.subscribe('pg-libpq:query', onQuery);
+  });
+
+  afterEach(()=>{
+    diagnostics_channel.unsubscribe('pg-libpq:query', onQuery);
+  });
+
+  it('should publish a latency breakdown per query', async ()=>{
+    const sql = "SELECT i, 'abc' AS t FROM generate_series(1, 3) AS i";
+    // one query at a time so the second waits in the queue while the first executes
+    PG.setQueueDepth({depth: 1});
+    try {
+      await Promise.all([pg.exec(sql), pg.execParams('SELECT $1::int AS a', [5])]);
+    } finally {
+      PG.setQueueDepth();
+    }
+
+    assert.equal(entries.length, 2);
+    const [entry] = entries;
+    assert.equal(entry.name, sql);
+    assert.equal(entry.entryType, 'pg-libpq');
+    assert.equal(typeof entry.startTime, 'number');
+    const {detail} = entry;
+    assert.equal(detail.rows, 3);
+    assert.equal(detail.bytes, 12);
+    assert.equal(detail.error, null);
+    for (const stage of ['queue', 'wait', 'execute', 'handoff', 'convert']) {
+      assert(detail[stage] >= 0, stage);
+      assert(detail[stage] <= entry.duration, stage);
+    }
+    assert(detail.execute > 0);
+
+    assert.equal(entries[1].name, 'SELECT $1::int AS a');
+    assert.equal(entries[1].detail.rows, 1);
+    // the first query may start executing before the second is queued
+    assert(entries[1].startTime - entry.startTime + entries[1].detail.queue >= detail.execute);
+  });
+
+  it('should publish errors and prepared statement names', async ()=>{
+    await pg.prepare('diag1', 'SELECT $1::int AS a');
+    await pg.execPrepared('diag1', [2]);
+    await assert.rejects(pg.exec('SELECT x_no_such_column'), /x_no_such_column/);
+
+    assert.deepEqual(entries.map(e => e.name), ['diag1', 'diag1', 'SELECT x_no_such_column']);
+    assert.equal(entries[1].detail.rows, 1);
+    assert.equal(entries[2].detail.error.sqlState, '42703');
+  });
+
+  it('should not publish without subscribers', async ()=>{
+    diagnostics_channel.unsubscribe('pg-libpq:query', onQuery);
+    await pg.exec('SELECT 1');
+    assert.equal(entries.length, 0);
+  });
+});
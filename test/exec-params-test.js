@@ -53,4 +53,31 @@ describe('execParams', ()=>{
     }).then(done, done);
   });
 
+  it('should encode primitive values natively', async ()=>{
+    const [row] = await pg.execParams(
+      "SELECT $1::float8 AS a, $2::int8 AS b, $3::bool AS c, $4::bytea AS d, $5::text AS e,"+
+        " $6::numeric::text AS f, $7::text AS g",
+      [0.1, 2n**40n, false, new Uint16Array([1, 0x0203]), null, 1/3, -12]);
+    assert.strictEqual(row.a, 0.1);
+    assert.strictEqual(row.b, 2**40);
+    assert.strictEqual(row.c, false);
+    assert.equal(row.d.toString('hex'), '01000302');
+    assert.strictEqual(row.e, void 0);
+    assert.strictEqual(row.f, '0.3333333333333333');
+    assert.strictEqual(row.g, '-12');
+  });
+
+  it('should encode BC dates', async ()=>{
+    const date = new Date(-62135596800001);
+    const [row] = await pg.execParams("SELECT $1::timestamp AS a", [date]);
+    assert.equal(+row.a, +date);
+  });
+
+  it('should reject params that can not be encoded', async ()=>{
+    const cyclic = {};
+    cyclic.self = cyclic;
+    await assert.rejects(pg.execParams("SELECT $1::jsonb AS a", [cyclic]), TypeError);
+    await assert.rejects(pg.execParams("SELECT $1::timestamp AS a", [new Date(NaN)]), RangeError);
+    assert.deepEqual(await pg.execParams("SELECT $1::int AS a", [1]), [{a: 1}]);
+  });
 });
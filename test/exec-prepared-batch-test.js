@@ -0,0 +1,76 @@
+const PG = require('../');
+const assert = require('assert');
+
+describe('execPreparedBatch', ()=>{
+  let pg;
+  before(done =>{
+    pg = new PG(err =>{
+      if (err) return done(err);
+      pg.exec('CREATE TEMP TABLE batch_t (id integer PRIMARY KEY, name text)')
+        .then(()=> pg.prepare('batch_ins', 'INSERT INTO batch_t VALUES ($1, $2)'))
+        .then(()=> done(), done);
+    });
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  beforeEach(()=> pg.exec('DELETE FROM batch_t'));
+
+  it('should return a row count per set', async ()=>{
+    const sets = Array.from({length: 1000}, (_, i)=> [i, 'n' + i]);
+    const counts = await pg.execPreparedBatch('batch_ins', sets);
+    assert.equal(counts.length, 1000);
+    assert(counts.every(c => c === 1));
+    const [{count}] = await pg.exec('SELECT count(*)::int AS count FROM batch_t');
+    assert.equal(count, 1000);
+  });
+
+  it('should return rows for each set', async ()=>{
+    await pg.prepare('batch_sel', 'SELECT $1::int * g AS v FROM generate_series(1, $2::int) g');
+    const results = await pg.execPreparedBatch('batch_sel', [[2, 2], [3, 0], [5, 1]]);
+    assert.deepEqual(results, [[{v: 2}, {v: 4}], [], [{v: 5}]]);
+  });
+
+  it('should accept an empty batch', done =>{
+    pg.execPreparedBatch('batch_ins', [], (err, results)=>{
+      try {
+        assert.ifError(err);
+        assert.deepEqual(results, []);
+        done();
+      } catch(err) {done(err)}
+    });
+  });
+
+  it('should roll back all sets when one fails', async ()=>{
+    try {
+      await pg.execPreparedBatch('batch_ins', [[1, 'a'], [2, 'b'], [1, 'dup'], [3, 'c']]);
+      assert.fail('expected error');
+    } catch(err) {
+      assert.equal(err.batchIndex, 2);
+      assert.equal(err.sqlState, '23505');
+      assert(/duplicate key/.test(err.message));
+    }
+    const [{count}] = await pg.exec('SELECT count(*)::int AS count FROM batch_t');
+    assert.equal(count, 0);
+    assert.deepEqual(await pg.execPreparedBatch('batch_ins', [[1, 'a']]), [1]);
+  });
+
+  it('should join an open transaction', async ()=>{
+    await pg.exec('BEGIN');
+    await pg.execPreparedBatch('batch_ins', [[7, 'a'], [8, 'b']]);
+    await pg.exec('ROLLBACK');
+    const [{count}] = await pg.exec('SELECT count(*)::int AS count FROM batch_t');
+    assert.equal(count, 0);
+  });
+
+  it('should reject sets that are not arrays', ()=>{
+    assert.throws(()=> pg.execPreparedBatch('batch_ins', [[1, 'a'], 2]), /array of arrays/);
+  });
+
+  it('should report an unknown statement', async ()=>{
+    await assert.rejects(pg.execPreparedBatch('batch_nope', [[1]]), err => err.sqlState === '26000');
+  });
+});
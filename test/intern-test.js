@@ -0,0 +1,66 @@
+const PG = require('../');
+const assert = require('assert');
+
+describe('string interning', ()=>{
+  let pg;
+  before(async ()=>{
+    pg = await PG.connect();
+    await pg.exec(`CREATE TYPE pg_libpq_mood AS ENUM ('sad', 'ok', 'happy')`);
+  });
+
+  after(async ()=>{
+    PG.setInternStrings();
+    if (pg) {
+      await pg.exec('DROP TYPE pg_libpq_mood');
+      pg.finish();
+    }
+    pg = null;
+  });
+
+  afterEach(()=>{
+    PG.setInternStrings();
+    PG.registerType(25, null);
+  });
+
+  const repeated = `SELECT i,
+(ARRAY['active','pending','clösed'])[i % 3 + 1] AS status,
+(ARRAY['NZ','AU'])[i % 2 + 1]::varchar AS country,
+(ARRAY['sad','ok','happy'])[i % 3 + 1]::pg_libpq_mood AS mood,
+CASE WHEN i % 5 = 0 THEN NULL ELSE 'x' END AS maybe,
+'{a,b}'::varchar AS braces,
+repeat('long value ', 10) AS long,
+'unique ' || i AS uniq
+FROM generate_series(1, 3000) AS i`;
+
+  const expected = i =>{
+    const row = {
+      i, status: ['active','pending','clösed'][i % 3], country: ['NZ','AU'][i % 2],
+      mood: ['sad','ok','happy'][i % 3], braces: ['a', 'b'],
+      long: 'long value '.repeat(10), uniq: 'unique ' + i,
+    };
+    if (i % 5 != 0) row.maybe = 'x';
+    return row;
+  };
+
+  it('should return the same values with interning on or off', async ()=>{
+    const on = await pg.exec(repeated);
+    PG.setInternStrings({maxLength: 0});
+    const off = await pg.exec(repeated);
+    assert.equal(on.length, 3000);
+    assert.deepStrictEqual(on, off);
+    for (let i = 1; i <= 3000; i += 499) assert.deepStrictEqual(on[i-1], expected(i));
+  });
+
+  it('should respect maxLength and registered parsers', async ()=>{
+    PG.setInternStrings({maxLength: 1});
+    assert.deepStrictEqual((await pg.exec(repeated))[3], expected(4));
+    PG.registerType(25, v => v.toUpperCase());
+    const rows = await pg.exec(repeated);
+    assert.equal(rows[0].status, 'PENDING');
+    assert.equal(rows[0].uniq, 'UNIQUE 1');
+  });
+
+  it('should reject a negative length', ()=>{
+    assert.throws(()=> PG.setInternStrings({maxLength: -1}), RangeError);
+  });
+});
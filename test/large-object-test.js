@@ -0,0 +1,86 @@
+const PG = require('../');
+const assert = require('assert');
+const {pipeline} = require('stream/promises');
+const {Readable, Writable} = require('stream');
+
+const collect = async readable =>{
+  const chunks = [];
+  for await (const chunk of readable) chunks.push(chunk);
+  return chunks;
+};
+
+describe('large objects', ()=>{
+  let pg;
+  before(done =>{
+    pg = new PG(done);
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  it('should write and read back in chunks', async ()=>{
+    const data = Buffer.alloc(100000);
+    for (let i = 0; i < data.length; ++i) data[i] = i * 7;
+    const ws = pg.loWriteStream({chunkSize: 30000});
+    await pipeline(Readable.from([data.subarray(0, 10), data.subarray(10)]), ws);
+    assert(ws.oid > 0);
+    await pg.exec('ROLLBACK');
+
+    const chunks = await collect(pg.loReadStream(ws.oid, {chunkSize: 40000}));
+    assert.deepEqual(chunks.map(c => c.length), [40000, 40000, 20000]);
+    assert(Buffer.concat(chunks).equals(data));
+
+    await pg.execParams('SELECT lo_unlink($1)', [ws.oid]);
+  });
+
+  it('should stream a large object a chunk at a time', async ()=>{
+    const chunk = Buffer.alloc(1 << 20, 'x');
+    let remaining = 64;
+    const source = new Readable({read() {this.push(remaining-- > 0 ? chunk : null)}});
+    const ws = pg.loWriteStream();
+    await pipeline(source, ws);
+
+    let total = 0, largest = 0;
+    await pipeline(pg.loReadStream(ws.oid), new Writable({
+      highWaterMark: 1,
+      write(c, enc, cb) {
+        total += c.length;
+        largest = Math.max(largest, c.length);
+        setImmediate(cb);
+      },
+    }));
+    assert.equal(total, 64 << 20);
+    assert.equal(largest, 65536);
+    await pg.execParams('SELECT lo_unlink($1)', [ws.oid]);
+  });
+
+  it('should use an open transaction', async ()=>{
+    await pg.exec('BEGIN');
+    const ws = pg.loWriteStream();
+    await pipeline(Readable.from([Buffer.from('hello')]), ws);
+    assert.equal(Buffer.concat(await collect(pg.loReadStream(ws.oid))).toString(), 'hello');
+    await pg.exec('ROLLBACK');
+    await assert.rejects(collect(pg.loReadStream(ws.oid)), /does not exist/);
+    assert.deepEqual(await pg.exec('SELECT 1 AS a'), [{a: 1}]);
+  });
+
+  it('should start its transaction before queries queued after it', async ()=>{
+    const ws = pg.loWriteStream();
+    // queued just after the stream's construct tick; SAVEPOINT fails outside a transaction block
+    let savepoint;
+    await new Promise(resolve => process.nextTick(()=>{
+      savepoint = pg.exec('SAVEPOINT after_lo');
+      resolve();
+    }));
+    await pipeline(Readable.from([Buffer.from('hi')]), ws);
+    await savepoint;
+    assert.equal(Buffer.concat(await collect(pg.loReadStream(ws.oid))).toString(), 'hi');
+    await pg.execParams('SELECT lo_unlink($1)', [ws.oid]);
+  });
+
+  it('should validate chunkSize', ()=>{
+    assert.throws(()=> pg.loReadStream(1, {chunkSize: 0}), RangeError);
+  });
+});
@@ -0,0 +1,105 @@
+const PG = require('../');
+const assert = require('assert');
+const {Readable} = require('stream');
+
+const collect = async readable =>{
+  const chunks = [];
+  for await (const chunk of readable) chunks.push(chunk);
+  return Buffer.concat(chunks).toString();
+};
+
+const sortedLines = text => text.split('\n').filter(l => l !== '').sort();
+
+describe('parallel copy', ()=>{
+  let pg, clients;
+  before(async ()=>{
+    pg = await PG.connect();
+    clients = await PG.connectMany('', 3);
+    await pg.exec(`DROP TABLE IF EXISTS pcopy_src, pcopy_dst;
+                   CREATE TABLE pcopy_src (id int PRIMARY KEY, v text);
+                   INSERT INTO pcopy_src SELECT i, md5(i::text) FROM generate_series(1, 20000) i;
+                   CREATE TABLE pcopy_dst (id int PRIMARY KEY, v text)`);
+  });
+
+  after(async ()=>{
+    if (clients) for (const c of clients) c.finish();
+    clients = null;
+    if (pg) {
+      await pg.exec('DROP TABLE IF EXISTS pcopy_src, pcopy_dst');
+      pg.finish();
+    }
+    pg = null;
+  });
+
+  const exportAll = async options =>{
+    const parts = [];
+    const n = await PG.parallelCopyTo(clients, {table: 'pcopy_src', ...options}, async (rs, part)=>{
+      if (part.index === 0)
+        await pg.exec("INSERT INTO pcopy_src VALUES (30000, 'late')");
+      parts[part.index] = await collect(rs);
+    });
+    assert.equal(parts.length, n);
+    return parts;
+  };
+
+  it('should export ctid ranges from one snapshot', async ()=>{
+    const expected = sortedLines(await collect(pg.copyToStream('COPY pcopy_src TO STDOUT')));
+    try {
+      const parts = await exportAll({parts: 5});
+      assert.equal(parts.length, 5);
+      assert(parts.every(p => p.length > 0));
+      assert.deepEqual(sortedLines(parts.join('')), expected);
+    } finally {
+      await pg.exec('DELETE FROM pcopy_src WHERE id = 30000');
+    }
+  });
+
+  it('should export key ranges', async ()=>{
+    try {
+      const done = [];
+      const parts = await exportAll({key: 'id', columns: ['id'], options: 'FORMAT csv',
+                                     progress: (part, n, total)=>{done.push([n, total])}});
+      assert.equal(parts.length, 3);
+      assert.deepEqual(done, [[1, 3], [2, 3], [3, 3]]);
+      assert.deepEqual(parts.map(p => sortedLines(p).length), [6667, 6667, 6666]);
+      assert.equal(sortedLines(parts[0]).map(Number).sort((a, b)=> a - b)[0], 1);
+    } finally {
+      await pg.exec('DELETE FROM pcopy_src WHERE id = 30000');
+    }
+    assert.deepEqual(await clients[1].exec('SELECT 1 AS a'), [{a: 1}]);
+  });
+
+  it('should end every transaction when the snapshot cannot be shared', async ()=>{
+    // a query already run in its transaction makes the third client's BEGIN fail
+    await clients[2].exec('BEGIN; SELECT 1');
+    await assert.rejects(PG.parallelCopyTo(clients, {table: 'pcopy_src'}, ()=>{}),
+                         /must be called before any query/);
+    for (const client of clients)
+      assert.deepEqual(await client.exec("SELECT current_setting('transaction_isolation') AS i"),
+                       [{i: 'read committed'}]);
+  });
+
+  it('should import row-aligned chunks over each connection', async ()=>{
+    const text = await collect(pg.copyToStream('COPY pcopy_src TO STDOUT'));
+    const input = Readable.from((function *() {
+      for (let i = 0; i < text.length; i += 1000) yield text.slice(i, i + 1000);
+    })());
+    const {bytes, chunks} = await PG.parallelCopyFrom(
+      clients, input, {table: 'pcopy_dst', chunkSize: 16384});
+    assert.equal(bytes, Buffer.byteLength(text));
+    assert(chunks > 3);
+    assert.deepEqual(await pg.exec(
+      `SELECT count(*)::int AS n FROM pcopy_dst d JOIN pcopy_src s USING (id, v)`), [{n: 20000}]);
+  });
+
+  it('should roll back every connection when a chunk fails', async ()=>{
+    await pg.exec('TRUNCATE pcopy_dst');
+    const lines = Array.from({length: 3000}, (_, i)=> `${i + 1}\tx\n`);
+    lines[2500] = 'bad\tx\n';
+    await assert.rejects(
+      PG.parallelCopyFrom(clients, Readable.from(lines), {table: 'pcopy_dst', chunkSize: 1000}),
+      /invalid input syntax/);
+    assert.deepEqual(await pg.exec('SELECT count(*)::int AS n FROM pcopy_dst'), [{n: 0}]);
+    for (const c of clients) assert.deepEqual(await c.exec('SELECT 1 AS a'), [{a: 1}]);
+  });
+});
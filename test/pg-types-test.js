@@ -49,6 +49,58 @@ describe('return types', ()=>{
     assert.deepEqual(await selectType(pg, 'varchar[]', '{{a,b},{c,d}}'), [['A','B'], ['C','D']]);
   });
 
+  it('should report parser exceptions', async ()=>{
+    const text = PG.registerType(25, v =>{throw new Error('bad '+v)});
+    try {
+      await assert.rejects(selectType(pg, 'text', 'value'), /bad value/);
+      assert.equal(await selectType(pg, 'int4', 1), 1);
+    } finally {
+      PG.registerType(25, text);
+    }
+  });
+
+  it('should let parsers call back into the client', async ()=>{
+    const queued = [];
+    const text = PG.registerType(25, v =>{
+      queued.push(pg.execParams('SELECT length($1) AS n', [v]));
+      return pg.escapeLiteral(v);
+    });
+    try {
+      assert.equal(await selectType(pg, 'text', 'abc'), "'abc'");
+    } finally {
+      PG.registerType(25, text);
+    }
+    assert.deepEqual(await Promise.all(queued), [[{n: 3}]]);
+  });
+
+  it('should parse json with JSON.parse', ()=>{
+    const prev = PG.registerType(114);
+    PG.registerType(114, prev);
+    assert.strictEqual(prev, JSON.parse);
+  });
+
+  it('should give date parsers milliseconds as before', async ()=>{
+    const seen = [];
+    const prev = PG.registerType(1114, v =>{seen.push(v); return v});
+    const prevArray = PG.registerType(1115, v =>{seen.push(v); return v});
+    try {
+      assert.equal(await selectType(pg, 'timestamp', '2020-01-02 03:04:05.5'),
+                   Date.UTC(2020, 0, 2, 3, 4, 5, 500));
+      assert.deepEqual(await selectType(pg, 'timestamp[]', '{1970-01-01,infinity,-infinity}'),
+                       [0, Infinity, -Infinity]);
+      assert.equal(seen.length, 4);
+    } finally {
+      PG.registerType(1114, prev);
+      PG.registerType(1115, prevArray);
+    }
+    assert.equal((await selectType(pg, 'timestamp', '2020-01-02')).getTime(), Date.UTC(2020, 0, 2));
+    assert.strictEqual(PG.registerType(1114), prev);
+    PG.registerType(1115);
+    const d = await selectType(pg, 'timestamp', '2020-01-02');
+    assert(d instanceof Date);
+    assert.equal(d.getTime(), Date.UTC(2020, 0, 2));
+  });
+
   it('should handle nested arrays', async ()=>{
     assert.deepStrictEqual(await selectType(pg, 'int2[]', '{}'), []);
     assert.deepStrictEqual(await selectType(pg, 'int2[]', '{{1,2},{3,4}}'), [[1,2], [3,4]]);
@@ -113,6 +165,18 @@ describe('return types', ()=>{
                            ["hello world", "1234"]);
   });
 
+  it('should return ascii and unicode strings of any length', async ()=>{
+    for (const len of [0, 1, 7, 8, 9, 31, 32, 33, 100]) {
+      const ascii = 'x'.repeat(len);
+      assert.strictEqual(await selectType(pg, 'text', ascii), ascii);
+      for (const ch of ['ü', '€', '😀', '\x7f']) {
+        const text = ascii + ch;
+        assert.strictEqual(await selectType(pg, 'text', text), text);
+        assert.strictEqual(await selectType(pg, 'text', ch + ascii), ch + ascii);
+      }
+    }
+  });
+
   it('should convert json', async ()=>{
     assert.strictEqual(await selectType(pg, 'json', true), true);
     assert.deepStrictEqual(await selectType(pg, 'json', [1,false,"a"]), [1,false,"a"]);
@@ -201,6 +265,95 @@ describe('return types', ()=>{
       ]);
   });
 
+  it('should convert extended types as text by default', async ()=>{
+    assert.strictEqual(await selectType(pg, 'uuid', 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'),
+                       'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11');
+    assert.strictEqual(await selectType(pg, 'numeric', '12345678901234567890.123'),
+                       '12345678901234567890.123');
+    assert.deepStrictEqual(await selectType(pg, 'numeric[]', '{1.5,NaN}'), ['1.5', 'NaN']);
+    assert.strictEqual(await selectType(pg, 'interval', '1 day 02:00:00'), '1 day 02:00:00');
+    assert.deepStrictEqual(await selectType(pg, 'inet[]', '{10.0.0.1,::1/64}'),
+                           ['10.0.0.1', '::1/64']);
+    assert.deepStrictEqual(await selectType(pg, 'point[]', '{"(1,2)","(3.5,-4)"}'),
+                           ['(1,2)', '(3.5,-4)']);
+    assert.deepStrictEqual(await selectType(pg, 'box[]', '{(1,1),(0,0);(3,3),(2,2)}'),
+                           ['(1,1),(0,0)', '(3,3),(2,2)']);
+  });
+
+  describe('setTypeMode', ()=>{
+    const restore = [];
+    const setMode = (oid, mode)=>{restore.push([oid, PG.setTypeMode(oid, mode)])};
+
+    afterEach(()=>{
+      for (const [oid, mode] of restore) PG.setTypeMode(oid, mode);
+      restore.length = 0;
+    });
+
+    it('should reject unsupported modes', ()=>{
+      assert.throws(()=>{PG.setTypeMode(25, 'number')}, RangeError);
+      assert.throws(()=>{PG.setTypeMode(2950, 'object')}, RangeError);
+      assert.throws(()=>{PG.setTypeMode(2950, 'bad')}, /invalid type mode/);
+    });
+
+    it('should convert uuid to buffer', async ()=>{
+      setMode(2950, 'buffer');
+      assert.equal((await selectType(pg, 'uuid', 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'))
+                   .toString('hex'), 'a0eebc999c0b4ef8bb6d6bb9bd380a11');
+      assert.deepEqual((await selectType(pg, 'uuid[]', '{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11}'))
+                       .map(v => v.toString('hex')), ['a0eebc999c0b4ef8bb6d6bb9bd380a11']);
+    });
+
+    it('should convert numeric and money to number', async ()=>{
+      setMode(1700, 'number');
+      setMode(790, 'number');
+      assert.strictEqual(await selectType(pg, 'numeric', '-123.25'), -123.25);
+      assert.deepStrictEqual(await selectType(pg, 'numeric[]', '{1.5,2}'), [1.5, 2]);
+      assert.strictEqual(await selectType(pg, 'money', '-1234.56'), -1234.56);
+      assert.deepStrictEqual(await selectType(pg, 'money[]', '{1234.5,2}'), [1234.5, 2]);
+      assert.strictEqual(await selectType(pg, 'money', '1234567'), 1234567);
+    });
+
+    it('should convert interval to object', async ()=>{
+      setMode(1186, 'object');
+      assert.deepStrictEqual(
+        await selectType(pg, 'interval', '1 year 2 months -3 days 04:05:06.789'),
+        {years: 1, months: 2, days: -3, hours: 4, minutes: 5, seconds: 6, milliseconds: 789});
+      assert.deepStrictEqual(
+        await selectType(pg, 'interval[]', '{"-00:00:01.5"}'),
+        [{years: 0, months: 0, days: 0, hours: 0, minutes: 0, seconds: -1, milliseconds: -500}]);
+    });
+
+    it('should convert inet and cidr to object', async ()=>{
+      setMode(869, 'object');
+      setMode(650, 'object');
+      assert.deepStrictEqual(await selectType(pg, 'inet', '10.1.2.3'),
+                             {address: '10.1.2.3', prefix: 32});
+      assert.deepStrictEqual(await selectType(pg, 'cidr[]', '{10.1.0.0/16,::/0}'),
+                             [{address: '10.1.0.0', prefix: 16}, {address: '::', prefix: 0}]);
+    });
+
+    it('should convert geometric types to object', async ()=>{
+      setMode(600, 'object');
+      setMode(603, 'object');
+      assert.deepStrictEqual(await selectType(pg, 'point', '(1.5,-2)'), {x: 1.5, y: -2});
+      assert.deepStrictEqual(await selectType(pg, 'box[]', '{(1,1),(0,0);(3,3),(2,2)}'), [
+        [{x: 1, y: 1}, {x: 0, y: 0}], [{x: 3, y: 3}, {x: 2, y: 2}]]);
+    });
+
+    it('should convert ranges to object', async ()=>{
+      setMode(3908, 'object');
+      setMode(3912, 'object');
+      assert.deepStrictEqual(
+        await selectType(pg, 'tsrange', '[2020-01-01 10:00, 2020-01-02)'), {
+          lower: new Date(Date.UTC(2020, 0, 1, 10)),
+          upper: new Date(Date.UTC(2020, 0, 2)),
+          bounds: '[)'});
+      assert.deepStrictEqual(await selectType(pg, 'daterange[]', '{"[2020-01-01,)",empty}'), [
+        {lower: new Date(Date.UTC(2020, 0, 1)), upper: null, bounds: '[)'},
+        {empty: true}]);
+    });
+  });
+
   it('should return objects', done =>{
     pg.exec("SELECT '{\"a\": 1, \"b\": [1,2]}'::jsonb as object").then(result => {
       const actObject = result[0].object;
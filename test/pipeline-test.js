@@ -0,0 +1,116 @@
+const PG = require('../');
+const assert = require('assert');
+const diagnostics_channel = require('diagnostics_channel');
+
+const CIRCLE_OID = 718;
+
+describe('queued queries', ()=>{
+  let pg;
+  beforeEach(async ()=>{
+    pg = await PG.connect();
+  });
+
+  afterEach(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  /* A result that takes 100ms to convert followed by a query that takes 100ms to run; returns the
+     latency breakdown of both. */
+  const convertThenSleep = async ()=>{
+    const entries = [];
+    const onQuery = entry =>{entries.push(entry.detail)};
+    diagnostics_channel.subscribe('pg-libpq:query', onQuery);
+    PG.registerType(CIRCLE_OID, text =>{
+      const end = Date.now() + 100;
+      while (Date.now() < end);
+      return text;
+    });
+    try {
+      const [[a], [b]] = await Promise.all([
+        pg.exec("SELECT '<(0,0),1>'::circle AS c"),
+        pg.exec('SELECT pg_sleep(0.1), 2 AS b'),
+      ]);
+      assert.equal(a.c, '<(0,0),1>');
+      assert.equal(b.b, 2);
+      return entries;
+    } finally {
+      PG.registerType(CIRCLE_OID);
+      diagnostics_channel.unsubscribe('pg-libpq:query', onQuery);
+    }
+  };
+
+  it('should run the next query while converting the previous result', async ()=>{
+    const [first, second] = await convertThenSleep();
+    // the second query started executing before the first result finished converting
+    assert(second.queue + second.wait < first.convert, JSON.stringify([first, second]));
+  });
+
+  it('should run queries one at a time with a depth of 1', async ()=>{
+    assert.throws(()=> PG.setQueueDepth({depth: 5}), RangeError);
+    PG.setQueueDepth({depth: 1});
+    try {
+      const [first, second] = await convertThenSleep();
+      // the second query was only submitted after the first result was converted
+      assert(second.queue >= first.convert, JSON.stringify([first, second]));
+    } finally {
+      PG.setQueueDepth();
+    }
+  });
+
+  it('should complete queued queries in order', async ()=>{
+    const order = [];
+    const queries = [];
+    for (let i = 0; i < 20; ++i) {
+      if (i % 3 === 0)
+        queries.push(pg.execParams('SELECT $1::int AS i', [i]));
+      else if (i % 3 === 1)
+        queries.push(pg.exec(`SELECT ${i} AS i`));
+      else {
+        pg.prepare(`queued_${i}`, `SELECT ${i} AS i`);
+        queries.push(pg.execPrepared(`queued_${i}`, []));
+      }
+      queries[queries.length - 1].then(([row])=>{order.push(row.i)});
+    }
+    await Promise.all(queries);
+    assert.deepEqual(order, Array.from({length: 20}, (_, i)=> i));
+  });
+
+  it('should keep the error of each failed query', async ()=>{
+    const results = await Promise.allSettled([
+      pg.exec('SELECT 1 AS a'),
+      pg.exec('SELECT nope'),
+      pg.execParams('SELECT $1::int AS a', ['x']),
+      pg.exec('SELECT 2 AS a'),
+    ]);
+    assert.deepEqual(results.map(r => r.status),
+                     ['fulfilled', 'rejected', 'rejected', 'fulfilled']);
+    assert.equal(results[1].reason.sqlState, '42703');
+    assert.equal(results[2].reason.sqlState, '22P02');
+    assert.deepEqual(results[3].value, [{a: 2}]);
+  });
+
+  it('should keep order around requests that are not queued', async ()=>{
+    const results = await Promise.all([
+      pg.exec('SELECT 1 AS a'),
+      pg.execPreparedBatch('nope', [[1]]).catch(err => err.sqlState),
+      pg.exec('SELECT 2 AS a'),
+      pg.waitForNotify(1),
+      pg.exec('SELECT 3 AS a'),
+    ]);
+    assert.deepEqual(results, [[{a: 1}], '26000', [{a: 2}], [], [{a: 3}]]);
+  });
+
+  it('should fail queued queries when the connection is finished', async ()=>{
+    const queries = [
+      pg.exec('SELECT pg_sleep(1)'),
+      pg.exec('SELECT 1'),
+      pg.exec('SELECT 2'),
+      pg.exec('SELECT 3'),
+      pg.exec('SELECT 4'),
+    ].map(q => q.catch(err => err.message));
+    await new Promise(resolve => setTimeout(resolve, 20));
+    pg.finish();
+    assert.deepEqual(await Promise.all(queries), Array(5).fill('connection is closed'));
+  });
+});
@@ -0,0 +1,121 @@
+const PG = require('../');
+const assert = require('assert');
+
+const REPLICA = 'options=-cdefault_transaction_read_only=on';
+const DEAD = 'host=/nonexistent connect_timeout=1';
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+const backend = (pool, readOnly)=> pool.exec('SELECT pg_backend_pid() AS pid, '+
+  "current_setting('transaction_read_only') AS ro", {readOnly}).then(([row])=> row);
+
+describe('multi-host pool', ()=>{
+  let pool;
+  afterEach(()=>{
+    pool && pool.end();
+    pool = null;
+  });
+
+  it('should classify hosts and split reads from writes', async ()=>{
+    pool = await PG.Pool.connect({hosts: [REPLICA, '', DEAD], size: 2});
+    assert.deepEqual(pool.status().map(h =>[h.role, h.connections]),
+                     [['standby', 2], ['primary', 2], ['down', 0]]);
+    assert.equal((await backend(pool, false)).ro, 'off');
+    assert.equal((await backend(pool, true)).ro, 'on');
+    await pool.exec('CREATE TEMPORARY TABLE pool_t (a int)');
+  });
+
+  it('should balance reads by outstanding requests', async ()=>{
+    pool = await PG.Pool.connect({hosts: [REPLICA, REPLICA], size: 2});
+    const rows = await Promise.all(Array.from({length: 8}, ()=>
+      pool.exec('SELECT pg_backend_pid() AS pid, pg_sleep(0.02)', {readOnly: true})));
+    assert.equal(new Set(rows.map(([r])=> r.pid)).size, 4);
+    await assert.rejects(pool.exec('SELECT 1'), /no writable host/);
+  });
+
+  it('should fall back to the primary for reads', async ()=>{
+    pool = await PG.Pool.connect({hosts: ['', DEAD], size: 1});
+    assert.equal((await backend(pool, true)).ro, 'off');
+  });
+
+  it('should pin a client for a transaction', async ()=>{
+    pool = await PG.Pool.connect({hosts: ['', REPLICA], size: 3});
+    const pid = await pool.withClient({}, async client =>{
+      await client.exec('BEGIN');
+      const [{pid}] = await client.exec('SELECT pg_backend_pid() AS pid');
+      assert.equal((await client.exec('SELECT pg_backend_pid() AS pid'))[0].pid, pid);
+      await client.exec('COMMIT');
+      return pid;
+    });
+    assert.equal(typeof pid, 'number');
+  });
+
+  it('should not retry errors that leave the connection usable', async ()=>{
+    pool = await PG.Pool.connect({hosts: [REPLICA, ''], size: 1});
+    let calls = 0;
+    const text = PG.registerType(25, v =>{++calls; throw new Error('bad '+v)});
+    try {
+      await assert.rejects(pool.exec("SELECT 'x'::text AS t", {readOnly: true}), /bad x/);
+    } finally {
+      PG.registerType(25, text);
+    }
+    assert.equal(calls, 1);
+    assert.equal((await backend(pool, true)).ro, 'on');
+    assert.deepEqual(pool.status().map(h => h.connections), [1, 1]);
+  });
+
+  it('should keep a host whose top-up fails while a client still answers', async ()=>{
+    pool = await PG.Pool.connect({hosts: [''], size: 2});
+    const admin = await PG.connect();
+    const {connectMany} = PG;
+    PG.connectMany = ()=> Promise.reject(new Error('refused'));
+    try {
+      pool.size = 3;
+      await pool.checkHealth();
+      assert.deepEqual(pool.status().map(h =>[h.role, h.connections]), [['primary', 2]]);
+
+      const [first] = pool.hosts[0].clients;
+      const [{pid}] = await first.exec('SELECT pg_backend_pid() AS pid');
+      await admin.exec(`SELECT pg_terminate_backend(${pid})`);
+      await sleep(50);
+      await pool.checkHealth();
+      assert.deepEqual(pool.status().map(h =>[h.role, h.connections]), [['primary', 1]]);
+      assert.equal(first.isClosed(), true);
+      assert.equal((await backend(pool, false)).ro, 'off');
+    } finally {
+      PG.connectMany = connectMany;
+      admin.finish();
+    }
+  });
+
+  it('should fail over when a host loses its connections', async ()=>{
+    pool = await PG.Pool.connect({hosts: [REPLICA, ''], size: 2, retryInterval: 50});
+    const admin = await PG.connect();
+    const {connectMany} = PG;
+    try {
+      const rows = await Promise.all(Array.from({length: 4}, ()=>
+        pool.exec('SELECT pg_backend_pid() AS pid, pg_sleep(0.02)', {readOnly: true})));
+      const pids = new Set(rows.map(([r])=> r.pid));
+      assert.equal(pids.size, 2);
+      // the replica refuses new connections until it comes back
+      PG.connectMany = (conninfo, n)=> conninfo === REPLICA ?
+        Promise.reject(new Error('refused')) : connectMany(conninfo, n);
+      await admin.exec(`SELECT pg_terminate_backend(pid) FROM unnest('{${[...pids]}}'::int[]) pid`);
+      await sleep(50);
+
+      for (let i = 0; i < 4; ++i) assert.equal((await backend(pool, true)).ro, 'off');
+      for (let i = 0; i < 100 && pool.status()[0].role !== 'down'; ++i) await sleep(10);
+      assert.equal(pool.status()[0].role, 'down');
+
+      PG.connectMany = connectMany;
+      await sleep(60);
+      await pool.checkHealth();
+      assert.deepEqual(pool.status()[0], {
+        conninfo: REPLICA, role: 'standby', connections: 2, outstanding: 0});
+      assert.equal((await backend(pool, true)).ro, 'on');
+    } finally {
+      PG.connectMany = connectMany;
+      admin.finish();
+    }
+  });
+});
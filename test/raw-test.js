@@ -0,0 +1,57 @@
+const PG = require('../');
+const assert = require('assert');
+
+describe('raw results', ()=>{
+  let pg;
+  before(done =>{
+    pg = new PG(done);
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  it('should return cells as unconverted Buffers', async ()=>{
+    const [row] = await pg.exec(
+      "SELECT json_build_object('a', 1, 'b', 'ü') AS j, 42 AS n, NULL::text AS z, '\\x01'::bytea AS b",
+      {raw: true});
+    assert(Buffer.isBuffer(row.j));
+    assert.deepEqual(JSON.parse(row.j), {a: 1, b: 'ü'});
+    assert.equal(row.n.toString(), '42');
+    assert.equal(row.b.toString(), '\\x01');
+    assert(! ('z' in row));
+  });
+
+  it('should apply to execParams and execPrepared', async ()=>{
+    const [p] = await pg.execParams('SELECT $1::int + 1 AS v', [1], {raw: true});
+    assert.equal(p.v.toString(), '2');
+    await pg.prepare('raw_p', 'SELECT $1::text AS v');
+    const [q] = await pg.execPrepared('raw_p', ['x'], {raw: true});
+    assert.equal(q.v.toString(), 'x');
+  });
+
+  it('should only apply to the query it is given for', done =>{
+    pg.exec('SELECT 1 AS v', {raw: true}, (err, raw)=>{
+      if (err) return done(err);
+      pg.exec('SELECT 1 AS v', (err, rows)=>{
+        try {
+          assert.ifError(err);
+          assert(Buffer.isBuffer(raw[0].v));
+          assert.strictEqual(rows[0].v, 1);
+          done();
+        } catch(err) {done(err)}
+      });
+    });
+  });
+
+  it('should not call registered type parsers', async ()=>{
+    const json = PG.registerType(114, text => 'parsed');
+    try {
+      const [row] = await pg.exec(`SELECT '{"x":1}'::json AS j`, {raw: true});
+      assert.equal(row.j.toString(), '{"x":1}');
+    } finally {
+      PG.registerType(114, json);
+    }
+  });
+});
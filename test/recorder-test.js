@@ -0,0 +1,66 @@
+const PG = require('../');
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const {readRecording, replay} = require('../lib/recorder');
+
+describe('recording and replay', ()=>{
+  let clients, file;
+  before(async ()=>{
+    clients = await PG.connectMany('', 2);
+    file = path.join(os.tmpdir(), `pg-libpq-recording-${process.pid}.ndjson`);
+  });
+
+  after(()=>{
+    if (clients) for (const c of clients) c.finish();
+    clients = null;
+    fs.rmSync(file, {force: true});
+  });
+
+  it('should record statements, params and timings per connection', async ()=>{
+    const [a, b] = clients;
+    PG.startRecording(file);
+    assert.throws(()=> PG.startRecording(file), /already recording/);
+    try {
+      await Promise.all([
+        a.exec('SELECT 1'),
+        a.execParams('SELECT $1::bytea AS b, $2::int8 AS n, $3::json AS j',
+                     [Buffer.from([1, 2]), 12n, {x: [1]}]),
+        b.prepare('rec_p', 'SELECT $1::int + 1 AS v'),
+        b.execPrepared('rec_p', [4]),
+        b.execPreparedBatch('rec_p', [[1], [2]]),
+        assert.rejects(b.exec('SELECT nope')),
+      ]);
+    } finally {
+      await PG.stopRecording();
+    }
+    await a.exec('SELECT 2');
+
+    const entries = await readRecording(file);
+    assert.deepEqual(entries.map(e => [e.conn, e.kind, e.text, e.failed]), [
+      [1, 'q', 'SELECT 1', false],
+      [1, 'q', 'SELECT $1::bytea AS b, $2::int8 AS n, $3::json AS j', false],
+      [2, 'p', 'rec_p', false],
+      [2, 'e', 'rec_p', false],
+      [2, 'b', 'rec_p', false],
+      [2, 'q', 'SELECT nope', true],
+    ]);
+    assert.deepEqual(entries[1].params, [Buffer.from([1, 2]), 12n, {x: [1]}]);
+    assert.equal(entries[2].params, 'SELECT $1::int + 1 AS v');
+    assert.deepEqual(entries[4].params, [[1], [2]]);
+    for (const e of entries) assert(e.ms >= 0 && e.at >= 0);
+  });
+
+  it('should replay a recording and report the difference', async ()=>{
+    for (const speed of [1, 0]) {
+      const report = await replay(file, {speed});
+      assert.equal(report.entries, 6);
+      assert.equal(report.connections, 2);
+      assert.deepEqual(report.errors, {original: 1, replay: 1});
+      assert(report.replay.qps > 0 && report.replay.p95Ms >= report.replay.p50Ms);
+      assert.equal(report.statements.length, 6);
+      assert.equal(report.statements.find(s => s.kind === 'e').count, 1);
+    }
+  });
+});
@@ -0,0 +1,103 @@
+const PG = require('../');
+const assert = require('assert');
+
+describe('logical replication', ()=>{
+  let pg, repl;
+  before(async ()=>{
+    pg = await PG.connect();
+    await pg.exec(`DROP TABLE IF EXISTS repl_t; CREATE TABLE repl_t (id int PRIMARY KEY, v text);
+                   DROP PUBLICATION IF EXISTS repl_pub; CREATE PUBLICATION repl_pub FOR TABLE repl_t`);
+  });
+
+  // The server ends any later stream on a connection at once, so each test gets its own.
+  beforeEach(async ()=>{
+    repl = await PG.connect('replication=database');
+    await repl.exec('CREATE_REPLICATION_SLOT repl_slot TEMPORARY LOGICAL pgoutput');
+  });
+
+  afterEach(()=>{
+    repl && repl.finish();
+    repl = null;
+  });
+
+  after(async ()=>{
+    if (pg) {
+      await pg.exec('DROP PUBLICATION IF EXISTS repl_pub; DROP TABLE IF EXISTS repl_t');
+      pg.finish();
+    }
+    pg = null;
+  });
+
+  const confirmedFlush = async ()=>{
+    const [row] = await pg.exec(
+      "SELECT confirmed_flush_lsn::text AS lsn FROM pg_replication_slots WHERE slot_name = 'repl_slot'");
+    return PG.lsnToBigInt(row.lsn);
+  };
+
+  it('should convert LSNs', ()=>{
+    assert.equal(PG.lsnToBigInt('16/B374D848'), 0x16B374D848n);
+    assert.equal(PG.lsnToString(0x16B374D848n), '16/B374D848');
+    assert.throws(()=> PG.lsnToBigInt('16:0'), /invalid LSN/);
+  });
+
+  it('should stream decoded changes and confirm them', async ()=>{
+    const start = await confirmedFlush();
+    const rs = repl.replicationStream('repl_slot', {
+      options: {proto_version: '1', publication_names: 'repl_pub'}, statusInterval: 50,
+    });
+    await pg.exec("INSERT INTO repl_t VALUES (1, 'a'), (2, 'b')");
+
+    const kinds = [];
+    for await (const msg of rs) {
+      assert.match(msg.lsn, /^[0-9A-F]+\/[0-9A-F]+$/);
+      assert(msg.time instanceof Date);
+      kinds.push(String.fromCharCode(msg.data[0]));
+      if (kinds.length === 5) break;
+    }
+    assert.deepEqual(kinds, ['B', 'R', 'I', 'I', 'C']);
+
+    let flushed = await confirmedFlush();
+    for (let i = 0; i < 50 && flushed <= start; ++i) {
+      await new Promise(resolve => setTimeout(resolve, 20));
+      flushed = await confirmedFlush();
+    }
+    assert(flushed > start);
+
+    assert.deepEqual(await repl.exec('IDENTIFY_SYSTEM').then(rows => rows.length), 1);
+  });
+
+  it('should not confirm unacknowledged messages', async ()=>{
+    const rs = repl.replicationStream('repl_slot', {
+      options: {proto_version: '1', publication_names: 'repl_pub'}, statusInterval: 50,
+      autoAcknowledge: false,
+    });
+    await pg.exec("INSERT INTO repl_t VALUES (3, 'c')");
+    const before = await confirmedFlush();
+    const msgs = [];
+    for await (const msg of rs) {
+      msgs.push(msg);
+      if (msgs.length === 4) break;
+    }
+    assert.deepEqual(msgs.map(m => String.fromCharCode(m.data[0])), ['B', 'R', 'I', 'C']);
+    assert.equal(await confirmedFlush(), before);
+  });
+
+  it('should fail the stream when the server ends it with an error', async ()=>{
+    const rs = repl.replicationStream('repl_slot', {
+      options: {proto_version: '1', publication_names: 'repl_pub'}, statusInterval: 50,
+    });
+    await pg.exec("INSERT INTO repl_t VALUES (4, 'd')");
+    await assert.rejects(async ()=>{
+      for await (const msg of rs) {
+        if (String.fromCharCode(msg.data[0]) !== 'B') continue;
+        await pg.exec("SELECT pg_terminate_backend(active_pid) FROM pg_replication_slots "+
+                      "WHERE slot_name = 'repl_slot'");
+      }
+    }, /terminat/);
+  });
+
+  it('should validate arguments', ()=>{
+    assert.throws(()=> repl.replicationStream('bad slot'), /slot name/);
+    assert.throws(()=> repl.replicationStream('s', {startLsn: 'x'}), /invalid LSN/);
+  });
+});
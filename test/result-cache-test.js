@@ -0,0 +1,141 @@
+const PG = require('../');
+const assert = require('assert');
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+describe('result cache', ()=>{
+  let pg, listener;
+  before(async ()=>{
+    [pg, listener] = await PG.connectMany('', 2);
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    listener && listener.finish();
+    pg = listener = null;
+  });
+
+  it('should return cached rows without running the query', async ()=>{
+    const cache = new PG.ResultCache();
+    const first = await pg.exec('SELECT random() AS r', {cache});
+    const second = await pg.exec('SELECT random() AS r', {cache});
+    assert.strictEqual(second, first);
+    assert(Object.isFrozen(first[0]));
+    assert.equal(cache.hits, 1);
+    assert.equal(cache.misses, 1);
+    assert(cache.bytes > 0);
+    assert.notDeepEqual(await pg.exec('SELECT random() AS r'), first);
+
+    const viaCallback = await new Promise((resolve, reject)=>{
+      pg.exec('SELECT random() AS r', {cache}, (err, rows)=>{err ? reject(err) : resolve(rows)});
+    });
+    assert.strictEqual(viaCallback, first);
+  });
+
+  it('should freeze nested cells and refuse hits on a finished client', async ()=>{
+    const cache = new PG.ResultCache();
+    const q = `SELECT '{"a": {"b": [1]}}'::jsonb AS j, '{1,2}'::int[] AS a, '\\x01'::bytea AS x`;
+    const [row] = await pg.exec(q, {cache});
+    assert(Object.isFrozen(row.j.a.b) && Object.isFrozen(row.a));
+    assert.throws(()=>{'use strict'; row.j.a.b.push(2)}, TypeError);
+    // Buffer cells cannot be frozen; they are shared and must be left alone
+    assert.strictEqual((await pg.exec(q, {cache}))[0].x, row.x);
+
+    const other = await PG.connect();
+    await other.exec(q, {cache});
+    other.finish();
+    assert.throws(()=> other.exec(q, {cache}), /connection is closed/);
+    assert.equal(cache.hits, 2);
+  });
+
+  it('should key on params, statement kind and result mode', async ()=>{
+    const cache = new PG.ResultCache();
+    const q = 'SELECT $1::int + random() AS r';
+    const [a] = await pg.execParams(q, [1], {cache});
+    const [b] = await pg.execParams(q, [2], {cache});
+    assert(b.r > 1 && a.r < 2);
+    assert.strictEqual((await pg.execParams(q, [1], {cache}))[0], a);
+    const [raw] = await pg.execParams(q, [1], {cache, raw: true});
+    assert(Buffer.isBuffer(raw.r));
+    await pg.prepare('cache_p', q);
+    const [p] = await pg.execPrepared('cache_p', [1], {cache});
+    assert.notStrictEqual(p, a);
+    assert.equal(cache.size, 4);
+  });
+
+  it('should not confuse params of different types', async ()=>{
+    const cache = new PG.ResultCache();
+    const q = 'SELECT $1::text AS t';
+    const params = [[1234n], [Buffer.from([0x12, 0x34])], ['1234'], [1234], [true], ['true']];
+    const rows = [];
+    for (const p of params) rows.push((await pg.execParams(q, p, {cache}))[0]);
+    assert.equal(cache.size, params.length);
+    assert.equal(rows[1].t, '\\x1234');
+  });
+
+  it('should key object params the way they are encoded', async ()=>{
+    const cache = new PG.ResultCache();
+    const q = 'SELECT $1::text AS t';
+    const buf = Buffer.from([1, 0, 0, 0]);
+    const params = [[new Int32Array([1])], [{0: 1}], [buf], [[buf]],
+                    [[{type: 'Buffer', data: [1, 0, 0, 0]}]], [[1, [2]]], [['1', [2]]]];
+    const rows = [];
+    for (const p of params) rows.push((await pg.execParams(q, p, {cache}))[0].t);
+    assert.deepEqual(rows.slice(0, 3), ['\\x01000000', '{"0":1}', '\\x01000000']);
+    assert.equal(rows[3], rows[4]);
+    assert.equal(cache.size, params.length);
+
+    await assert.rejects(pg.execParams(q, [[1n]], {cache}), /BigInt/);
+    await assert.rejects(pg.execParams(q, [{a: 1n}], {cache}), /BigInt/);
+    assert.equal(cache.size, params.length);
+  });
+
+  it('should expire entries and bound their number', async ()=>{
+    const cache = new PG.ResultCache({ttl: 20, maxEntries: 2});
+    const [a] = await pg.exec('SELECT random() AS r', {cache});
+    await sleep(30);
+    assert.notStrictEqual((await pg.exec('SELECT random() AS r', {cache}))[0], a);
+    await pg.exec('SELECT 1 AS a', {cache});
+    await pg.exec('SELECT 2 AS a', {cache});
+    assert.equal(cache.size, 2);
+    await pg.exec('SELECT 1 AS a', {cache});
+    assert.equal(cache.misses, 4);
+  });
+
+  it('should not cache errors or command results', async ()=>{
+    const cache = new PG.ResultCache();
+    await assert.rejects(pg.exec('SELECT nope', {cache}), /nope/);
+    await pg.exec('CREATE TEMPORARY TABLE cache_tmp (a int)', {cache});
+    assert.equal(cache.size, 0);
+  });
+
+  it('should return nothing when no notification arrives', async ()=>{
+    const start = Date.now();
+    assert.deepEqual(await listener.waitForNotify(50), []);
+    assert(Date.now() - start >= 40);
+  });
+
+  it('should invalidate tables named by a notification', async ()=>{
+    const cache = new PG.ResultCache({ttl: 60000});
+    await cache.listen(listener, 'cache_inval');
+    const [a] = await pg.exec('SELECT random() AS r', {cache, tables: ['t1']});
+    const [b] = await pg.exec('SELECT random() + 1 AS r', {cache, tables: ['t2']});
+    await pg.exec("NOTIFY cache_inval, 't1'");
+    for (let i = 0; i < 100 && cache.size !== 1; ++i) await sleep(10);
+    assert.equal(cache.size, 1);
+    assert.notStrictEqual((await pg.exec('SELECT random() AS r', {cache, tables: ['t1']}))[0], a);
+    assert.strictEqual((await pg.exec('SELECT random() + 1 AS r', {cache}))[0], b);
+
+    await pg.exec("NOTIFY cache_inval");
+    for (let i = 0; i < 100 && cache.size !== 0; ++i) await sleep(10);
+    assert.equal(cache.size, 0);
+  });
+
+  it('should not store results that raced an invalidation', async ()=>{
+    const cache = new PG.ResultCache();
+    const pending = pg.exec('SELECT pg_sleep(0.05), 1 AS a', {cache, tables: ['t']});
+    cache.invalidate('t');
+    await pending;
+    assert.equal(cache.size, 0);
+  });
+});
@@ -0,0 +1,68 @@
+const PG = require('../');
+const assert = require('assert');
+
+describe('time-sliced conversion', ()=>{
+  let pg1, pg2;
+  before(async ()=>{
+    [pg1, pg2] = await Promise.all([PG.connect(), PG.connect()]);
+  });
+
+  after(()=>{
+    PG.setConvertBudget();
+    pg1 && pg1.finish();
+    pg2 && pg2.finish();
+    pg1 = pg2 = null;
+  });
+
+  afterEach(()=>{
+    PG.setConvertBudget();
+    PG.registerType(25, null);
+  });
+
+  const series = n => `SELECT i, 'r' || i AS t FROM generate_series(1, ${n}) AS i`;
+
+  it('should convert results in slices', async ()=>{
+    PG.setConvertBudget({rows: 7});
+    const [a, b] = await Promise.all([pg1.exec(series(1000)), pg2.exec(series(50))]);
+    assert.equal(a.length, 1000);
+    assert.deepEqual(a[999], {i: 1000, t: 'r1000'});
+    assert(a.every((r, i) => r.i === i+1));
+    assert.equal(b.length, 50);
+    assert.deepEqual(await pg1.exec('SELECT 1 AS a'), [{a: 1}]);
+  });
+
+  it('should yield to other connections during a big result', async ()=>{
+    PG.setConvertBudget({rows: 500, ms: 1});
+    const order = [];
+    const big = pg1.exec(series(100000)).then(rows =>{order.push('big'); return rows});
+    let small = 0;
+    const smalls = (async ()=>{
+      while (order.length == 0) {
+        await pg2.exec('SELECT 1');
+        ++small;
+      }
+    })();
+    assert.equal((await big).length, 100000);
+    await smalls;
+    assert(small > 0);
+  });
+
+  it('should report parser errors part way through', async ()=>{
+    PG.setConvertBudget({rows: 10});
+    PG.registerType(25, v =>{
+      if (v === 'r55') throw new Error('bad row');
+      return v;
+    });
+    await assert.rejects(pg1.exec(series(100)), /bad row/);
+    assert.equal((await pg1.exec(series(20))).length, 20);
+  });
+
+  it('should abort a partly converted result on finish', async ()=>{
+    const pg = await PG.connect();
+    PG.setConvertBudget({rows: 1});
+    const p = pg.exec(series(100000));
+    await new Promise(resolve => setTimeout(resolve, 50));
+    pg.finish();
+    await assert.rejects(p, /connection is closed/);
+  });
+});
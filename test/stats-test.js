@@ -0,0 +1,85 @@
+const PG = require('../');
+const assert = require('assert');
+const stream = require('stream');
+
+describe('stats', ()=>{
+  let pg;
+  before(async ()=>{
+    pg = await PG.connect();
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  const findStatement = key => PG.stats().statements.find(s => s.key === key);
+
+  it('should aggregate by normalised sql', async ()=>{
+    await pg.exec(`SELECT 1 AS a, 'x' AS b  -- first`);
+    await pg.exec(`SELECT 23.5e3 AS a,\n  'it''s' AS b`);
+    await pg.execParams(`SELECT $1::int AS a, 'y' AS b`, [4]);
+
+    const stat = findStatement(`SELECT ? AS a, ? AS b`);
+    assert.equal(stat.calls, 2);
+    assert.equal(stat.rows, 2);
+    assert.equal(stat.errors, 0);
+    assert.equal(stat.prepared, false);
+    assert.equal(stat.exec.count, 2);
+    assert.equal(stat.convert.count, 2);
+    assert(stat.exec.p50 <= stat.exec.p99);
+    assert(stat.exec.p99 <= stat.exec.max);
+    assert.equal(stat.exec.buckets.reduce((sum, [le, count]) => sum + count, 0), 2);
+
+    assert.equal(findStatement(`SELECT $1::int AS a, ? AS b`).calls, 1);
+  });
+
+  it('should aggregate by statement name', async ()=>{
+    await pg.prepare('stats1', 'SELECT $1::int AS a');
+    await pg.execPrepared('stats1', [1]);
+    await pg.execPrepared('stats1', [2]);
+
+    const stat = PG.stats().statements.find(s => s.key === 'stats1' && s.prepared);
+    assert.equal(stat.calls, 2);
+    assert.equal(stat.rows, 2);
+  });
+
+  it('should count errors by SQLSTATE', async ()=>{
+    const before = PG.stats().errors['42P01'] || 0;
+    const conn = pg.stats();
+    await assert.rejects(pg.exec('SELECT * FROM stats_no_such_table'), /stats_no_such_table/);
+
+    assert.equal(PG.stats().errors['42P01'], before+1);
+    assert.equal(findStatement('SELECT * FROM stats_no_such_table').errors, 1);
+    assert.equal(pg.stats().errors, conn.errors+1);
+  });
+
+  it('should count connection queries, rows and copy bytes', async ()=>{
+    const start = pg.stats();
+    await pg.exec('CREATE TEMPORARY TABLE stats_copy (a text)');
+    const data = 'one\ntwo\nthree\n';
+    await new Promise((resolve, reject)=>{
+      const to = pg.copyFromStream('COPY stats_copy FROM STDIN', err => err ? reject(err) : resolve());
+      to.end(data);
+    });
+    let received = '';
+    for await (const chunk of pg.copyToStream('COPY stats_copy TO STDOUT')) received += chunk;
+    assert.equal(received, data);
+    await pg.exec('SELECT * FROM stats_copy');
+
+    const end = pg.stats();
+    assert.equal(end.queries - start.queries, 4);
+    assert.equal(end.rows - start.rows, 3);
+    assert.equal(end.bytesSent - start.bytesSent, data.length);
+    assert.equal(end.bytesReceived - start.bytesReceived, data.length);
+  });
+
+  it('should account for PGresult memory', async ()=>{
+    const before = PG.allocStats();
+    await pg.exec(`SELECT repeat('x', 100000) AS a`);
+    const after = PG.allocStats();
+    assert(after.resultBytesTotal - before.resultBytesTotal > 100000);
+    assert.equal(after.resultBytes, before.resultBytes);
+    assert(after.threads > 0);
+  });
+});
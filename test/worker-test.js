@@ -0,0 +1,96 @@
+const PG = require('../');
+const assert = require('assert');
+const path = require('path');
+const {Worker} = require('worker_threads');
+
+const LIB = path.resolve(__dirname, '..');
+
+const runWorker = (body, workerData)=> new Promise((resolve, reject)=>{
+  const worker = new Worker(`
+const {parentPort, workerData} = require('worker_threads');
+const PG = require(${JSON.stringify(LIB)});
+(async ()=>{${body}})().then(r => parentPort.postMessage(r), err => {throw err});
+`, {eval: true, workerData});
+  let result;
+  worker.on('message', r =>{result = r});
+  worker.on('error', reject);
+  worker.on('exit', code => code == 0 ? resolve(result) : reject(new Error('exit ' + code)));
+});
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+describe('worker_threads', ()=>{
+  let pg;
+  before(async ()=>{
+    pg = await PG.connect();
+  });
+
+  after(()=>{
+    pg && pg.finish();
+    pg = null;
+  });
+
+  it('should run connections in several workers at once', async ()=>{
+    const body = `
+PG.registerType(25, v => v + '-' + workerData.n);
+PG.setConvertBudget({rows: 100});
+const [a, b] = await Promise.all([PG.connect(), PG.connect()]);
+const rows = [];
+for (let i = 0; i < 5; ++i) {
+  const [r1, r2] = await Promise.all([
+    a.execParams("SELECT i, 'w' || $1::text AS t FROM generate_series(1, 2000) AS i", [workerData.n]),
+    b.exec("SELECT 'x'::text AS t, '{\\"a\\": 1}'::jsonb AS j")]);
+  rows.push(r1.length, r1[1999].t, r2[0].t, r2[0].j.a);
+}
+a.finish(); b.finish();
+return rows;`;
+    const main = pg.exec(`SELECT 'main'::text AS t, pg_sleep(0.05)`);
+    const results = await Promise.all([1, 2, 3].map(n => runWorker(body, {n})));
+    results.forEach((rows, i)=>{
+      const n = i + 1;
+      for (let j = 0; j < rows.length; j += 4)
+        assert.deepStrictEqual(rows.slice(j, j+4), [2000, `w${n}-${n}`, `x-${n}`, 1]);
+    });
+    assert.equal((await main)[0].t, 'main');
+    assert.equal((await pg.exec(`SELECT 'a'::text AS t`))[0].t, 'a');
+  });
+
+  it('should keep type modes per worker', async ()=>{
+    const value = await runWorker(`
+PG.setTypeMode(1700, 'number');
+const pg = await PG.connect();
+const [{n}] = await pg.exec('SELECT 1.5::numeric AS n');
+pg.finish();
+return n;`);
+    assert.strictEqual(value, 1.5);
+    assert.strictEqual((await pg.exec('SELECT 1.5::numeric AS n'))[0].n, '1.5');
+  });
+
+  it('should close open connections when a worker exits', async ()=>{
+    const {threads} = PG.allocStats();
+    await runWorker(`
+const a = await PG.connect();
+const b = await PG.connect();
+await a.exec('SELECT 1');
+b.exec('SELECT pg_sleep(10)');
+await new Promise(resolve => setTimeout(resolve, 50));
+process.exit(0);`);
+    assert.equal(PG.allocStats().threads, threads);
+  });
+
+  it('should survive terminating a worker with a query in flight', async ()=>{
+    const {threads} = PG.allocStats();
+    const worker = new Worker(`
+const {parentPort} = require('worker_threads');
+const PG = require(${JSON.stringify(LIB)});
+PG.connect().then(pg =>{
+  pg.exec('SELECT pg_sleep(10)');
+  parentPort.postMessage('busy');
+});`, {eval: true});
+    await new Promise(resolve => worker.once('message', resolve));
+    await sleep(20);
+    await worker.terminate();
+    assert.equal(PG.allocStats().threads, threads);
+    assert.deepEqual(await pg.exec('SELECT 1 AS a'), [{a: 1}]);
+  });
+});
@@ -0,0 +1,89 @@
+/* Measure the native decoders without a server.
+   Build first with: node-gyp rebuild -- -Ddecode_bench=1
+   usage: node tools/decode-bench.js [--iterations=n] [--filter=regexp] [--values=recorded.json]
+
+   recorded.json is {"<oid>": ["text value", ...], ...}, for example captured with
+   SELECT array_agg(col::text) FROM ... */
+const fs = require('fs');
+const path = require('path');
+
+const DecodeBench = (()=>{
+  const dir = path.resolve(__dirname, '../build');
+  try {
+    return require(dir + '/Release/decode_bench.node');
+  } catch (err) {
+    return require(dir + '/Debug/decode_bench.node');
+  }
+})();
+
+const MODE = {text: 0, number: 1, object: 2, buffer: 3};
+
+const range = (n, f)=> Array.from({length: n}, (_, i)=> f(i));
+
+const SYNTHETIC = [
+  {name: 'bool', oid: 16, values: ['t', 'f']},
+  {name: 'int4', oid: 23, values: range(100, i => String(i * 7919))},
+  {name: 'int8', oid: 20, values: range(100, i => String(i * 1000000007))},
+  {name: 'float8', oid: 701, values: range(100, i => String(i / 7))},
+  {name: 'text', oid: 25, values: range(100, i => 'some text value ' + i)},
+  {name: 'textUnicode', oid: 25, values: range(100, i => 'ünïcödé ' + i)},
+  {name: 'textLong', oid: 25, values: range(20, i => 'a longer plain text value '.repeat(20) + i)},
+  {name: 'textLongUnicode', oid: 25, values: range(20, i => 'a longer plain text value '.repeat(20) + 'ü' + i)},
+  {name: 'bytea', oid: 17, values: range(20, i => '\\x' + Buffer.alloc(64, i).toString('hex'))},
+  {name: 'date', oid: 1082, values: range(100, i => `2020-01-${String(i % 28 + 1).padStart(2, '0')}`)},
+  {name: 'timestamptz', oid: 1184,
+   values: range(100, i => `2020-01-02 03:04:${String(i % 60).padStart(2, '0')}.${i}+13`)},
+  {name: 'uuid', oid: 2950, values: range(100, i => '58a7a0c4-29b3-4f5b-b6c4-' + String(i).padStart(12, '0'))},
+  {name: 'uuidBuffer', oid: 2950, mode: 'buffer',
+   values: range(100, i => '58a7a0c4-29b3-4f5b-b6c4-' + String(i).padStart(12, '0'))},
+  {name: 'numericNumber', oid: 1700, mode: 'number', values: range(100, i => (i * 3.14159).toFixed(5))},
+  {name: 'intervalObject', oid: 1186, mode: 'object',
+   values: range(100, i => `${i} years 2 mons -${i} days 04:05:06.${i}`)},
+  {name: 'tstzrangeObject', oid: 3910, mode: 'object',
+   values: ['["2020-01-01 00:00:00+00","2020-02-01 00:00:00+00")', '(,"2020-02-01 00:00:00+00"]']},
+  {name: 'int4[]', oid: 1007, values: range(20, i => '{' + range(50, j => i * j).join(',') + '}')},
+  {name: 'text[]', oid: 1009, values: range(20, i => '{' + range(50, j => j % 5 == 0 ? `"a \\"${j}\\""` : 'b' + j).join(',') + '}')},
+  {name: 'int4[][]', oid: 1007, values: ['{' + range(20, i => '{' + range(10, j => j).join(',') + '}').join(',') + '}']},
+  {name: 'timestamptz[]', oid: 1185,
+   values: range(20, i => '{' + range(10, j => `"2020-01-02 03:04:0${j}+00"`).join(',') + '}')},
+];
+
+const parseArgs = argv =>{
+  const opts = {iterations: 2000, filter: null, values: null};
+  for (const arg of argv) {
+    const [key, value] = arg.replace(/^--/, '').split('=');
+    if (key === 'iterations') opts.iterations = +value;
+    else if (key === 'filter') opts.filter = new RegExp(value);
+    else if (key === 'values') opts.values = value;
+    else throw new Error('unknown option ' + arg);
+  }
+  return opts;
+};
+
+const recorded = file =>{
+  const json = JSON.parse(fs.readFileSync(file));
+  return Object.keys(json).map(oid => ({name: 'recorded.' + oid, oid: +oid, values: json[oid]}));
+};
+
+const main = ()=>{
+  const opts = parseArgs(process.argv.slice(2));
+  const cases = opts.values === null ? SYNTHETIC : recorded(opts.values);
+  const results = [];
+  for (const {name, oid, mode='text', values} of cases) {
+    if (opts.filter !== null && ! opts.filter.test(name)) continue;
+    DecodeBench.setTypeMode(oid, MODE[mode]);
+    DecodeBench.bench(oid, values, Math.ceil(opts.iterations / 10));
+    const ns = DecodeBench.bench(oid, values, opts.iterations);
+    DecodeBench.setTypeMode(oid, MODE.text);
+    const count = values.length * opts.iterations;
+    const bytes = values.reduce((sum, v)=> sum + Buffer.byteLength(v), 0) * opts.iterations;
+    results.push({
+      name, oid, mode, values: count,
+      nsPerValue: +(ns / count).toFixed(1),
+      mbPerSec: +(bytes / (ns / 1e9) / 1048576).toFixed(1),
+    });
+  }
+  console.log(JSON.stringify({node: process.version, iterations: opts.iterations, results}, null, 2));
+};
+
+main();
@@ -1,3 +1,4 @@
+const fs = require('fs');
 const PG = require('../');
 
 let str;
@@ -48,6 +49,161 @@ const loop2 = ()=>{
   select();
 };
 
-const loop = loop1;
+const countAllocs = async ()=>{
+  const pg = await PG.connect();
+  const query = ()=> pg.execParams('SELECT $1::int AS a, $2::text AS b, $3::jsonb AS c',
+                                   [counter++, str, {counter}]);
+  for(let i = 0; i < 100; ++i) await query();
+
+  const count = 10000;
+  const before = PG.allocStats();
+  for(let i = 0; i < count; ++i) {
+    iter();
+    await query();
+  }
+  const after = PG.allocStats();
+  pg.finish();
+
+  console.log(JSON.stringify({
+    queries: count,
+    allocsPerQuery: (after.allocs - before.allocs)/count,
+    freesPerQuery: (after.frees - before.frees)/count,
+    arenaBytes: after.arenaBytes,
+  }));
+};
+
+const SHAPES = {
+  small: {sql: 'SELECT 1 AS a', count: 2000},
+  wide: {sql: `SELECT ${Array.from({length: 50}, (_, i)=> `i + ${i} AS c${i}, 'text ' || i AS t${i}`)
+.join(', ')} FROM generate_series(1, 200) AS i`, count: 50},
+  bytea: {sql: `SELECT decode(repeat('0123456789abcdef', 65536), 'hex') AS a`, count: 50},
+  array: {sql: 'SELECT array(SELECT generate_series(1, 100000)) AS a', count: 50},
+  json: {sql: `SELECT jsonb_build_object('id', i, 'name', 'name ' || i, 'tags', jsonb_build_array(
+'a', 'b', i)) AS a FROM generate_series(1, 2000) AS i`, count: 50},
+};
+
+const CONNECTIONS = 20, RETAIN = 3;
+
+const gc = (()=>{
+  if (global.gc) return global.gc;
+  require('v8').setFlagsFromString('--expose-gc');
+  return require('vm').runInNewContext('gc');
+})();
+
+const memory = ()=>{
+  gc(); gc();
+  const {rss, heapUsed, external, arrayBuffers} = process.memoryUsage();
+  const status = fs.existsSync('/proc/self/status') ? fs.readFileSync('/proc/self/status', 'utf8') : '';
+  const vm = /VmSize:\s+(\d+) kB/.exec(status);
+  return {rss, heapUsed, external: external + arrayBuffers, virtual: vm === null ? 0 : vm[1] * 1024,
+          ...PG.allocStats()};
+};
+
+const diff = (after, before, n, keys)=>{
+  const result = {};
+  for (const key of keys) result[key] = Math.round((after[key] - before[key]) / n);
+  return result;
+};
+
+const measureShape = async (pg, {sql, count})=>{
+  await pg.exec(sql);
+  const before = memory();
+  let peakRss = before.rss;
+  for (let i = 0; i < count; ++i) {
+    await pg.exec(sql);
+    const {rss} = process.memoryUsage();
+    if (rss > peakRss) peakRss = rss;
+  }
+  await pg.exec('SELECT 1');
+  const after = memory();
+  const retained = [];
+  for (let i = 0; i < RETAIN; ++i) retained.push(await pg.exec(sql));
+  await pg.exec('SELECT 1');
+  const held = memory();
+  return {
+    queries: count,
+    nativeAllocs: Math.round((after.allocs - before.allocs) / count),
+    nativeBytes: Math.round((after.allocBytes - before.allocBytes) / count),
+    resultBytes: Math.round((after.resultBytesTotal - before.resultBytesTotal) / count),
+    jsHeapBytes: Math.round((held.heapUsed - after.heapUsed + held.external - after.external) / RETAIN),
+    peakRssDelta: peakRss - before.rss,
+    rows: Array.isArray(retained[0]) ? retained[0].length : 0,
+  };
+};
+
+/* Let finalizers of collected connections run. */
+const settle = async ()=>{
+  for (let i = 0; i < 2; ++i) {
+    gc();
+    await new Promise(resolve => setTimeout(resolve, 50));
+  }
+};
+
+const measureConnections = async ()=>{
+  await settle();
+  const before = memory();
+  const clients = [];
+  for (let i = 0; i < CONNECTIONS; ++i) clients.push(await PG.connect());
+  await Promise.all(clients.map(pg => pg.exec('SELECT 1')));
+  const after = memory();
+  for (const pg of clients) pg.finish();
+  clients.length = 0;
+  await settle();
+  const finished = memory();
+  return {
+    connections: CONNECTIONS,
+    connSize: after.connSize,
+    threads: after.threads - before.threads,
+    perConnection: diff(after, before, CONNECTIONS, ['rss', 'virtual', 'heapUsed', 'allocBytes']),
+    leakedAllocs: (finished.allocs - finished.frees) - (before.allocs - before.frees),
+  };
+};
+
+/* Compare against a baseline report; growth over 10% (and 1KB) is a regression. */
+const compareReports = (baseline, report)=>{
+  let regressions = 0;
+  const check = (name, base, value)=>{
+    if (typeof value !== 'number' || typeof base !== 'number') return;
+    const regress = value > base * 1.1 && value - base > 1024;
+    if (regress) ++regressions;
+    if (value !== base)
+      console.error(`${regress ? 'REGRESSION' : 'changed'} ${name}: ${base} -> ${value}`);
+  };
+  for (const shape in report.shapes) {
+    const base = baseline.shapes[shape];
+    if (base === void 0) continue;
+    for (const key in report.shapes[shape])
+      check(`${shape}.${key}`, base[key], report.shapes[shape][key]);
+  }
+  for (const key in report.connections.perConnection)
+    check(`connection.${key}`, baseline.connections.perConnection[key],
+          report.connections.perConnection[key]);
+  return regressions;
+};
+
+const memoryBench = async ()=>{
+  let out = null, compare = null;
+  for (const arg of process.argv.slice(3)) {
+    const [key, value] = arg.replace(/^--/, '').split('=');
+    if (key === 'out') out = value;
+    else if (key === 'compare') compare = value;
+  }
+
+  const pg = await PG.connect();
+  const shapes = {};
+  for (const name in SHAPES) shapes[name] = await measureShape(pg, SHAPES[name]);
+  pg.finish();
+
+  const report = {node: process.version, shapes, connections: await measureConnections()};
+  const json = JSON.stringify(report, null, 2);
+  if (out === null) console.log(json);
+  else fs.writeFileSync(out, json + '\n');
+  if (compare !== null && compareReports(JSON.parse(fs.readFileSync(compare)), report) != 0)
+    process.exitCode = 1;
+};
+
+const MODES = {allocs: countAllocs, memory: memoryBench};
+
+const loop = MODES[process.argv[2]] || loop1;
 
 loop();
@@ -0,0 +1,56 @@
+const fs = require('fs');
+const {replay} = require('../lib/recorder');
+
+const usage = ()=>{
+  console.error(`usage: node tools/replay.js recording [--conninfo=string] [--speed=n] [--out=file]
+
+Replays a recording made with PG.startRecording; --speed=0 runs each connection's statements
+back to back instead of at their recorded times.`);
+  process.exit(1);
+};
+
+const parseArgs = argv =>{
+  const args = {path: null, conninfo: void 0, speed: 1, out: null};
+  for (const arg of argv) {
+    const m = /^--([a-z]+)=(.*)$/.exec(arg);
+    if (m === null) {
+      if (args.path !== null) usage();
+      args.path = arg;
+      continue;
+    }
+    const [, key, value] = m;
+    switch (key) {
+    case 'conninfo': args.conninfo = value; break;
+    case 'speed': args.speed = +value; break;
+    case 'out': args.out = value; break;
+    default: usage();
+    }
+  }
+  if (args.path === null || ! (args.speed >= 0)) usage();
+  return args;
+};
+
+const change = (from, to)=>{
+  const pct = from === 0 ? 0 : (to - from) / from * 100;
+  return (pct < 0 ? '' : '+') + pct.toFixed(1) + '%';
+};
+
+const main = async ()=>{
+  const {path, conninfo, speed, out} = parseArgs(process.argv.slice(2));
+  const report = await replay(path, {conninfo, speed});
+  const json = JSON.stringify(report, null, 2);
+  if (out === null) console.log(json);
+  else fs.writeFileSync(out, json + '\n');
+
+  const {original: o, replay: r} = report;
+  console.error(`${report.entries} statements on ${report.connections} connections, errors ${
+report.errors.original} -> ${report.errors.replay}`);
+  for (const key of ['qps', 'meanMs', 'p50Ms', 'p95Ms', 'p99Ms'])
+    console.error(`${key.padEnd(8)} ${String(o[key]).padStart(10)} -> ${String(r[key]).padStart(10)} ${
+change(o[key], r[key])}`);
+};
+
+main().catch(err =>{
+  console.error(err);
+  process.exit(1);
+});